@@ -0,0 +1,79 @@
+
+// Measures the cost of cothread_switch() and cothread_yield_to() in CPU cycles.
+// Timer A0 counts SMCLK, which runs from the same clock as MCLK after reset. The home thread and one
+// alternate thread switch back and forth, and the result is the average over all switches
+// including the loop overhead.
+// Run it in the debugger, stop at the breakpoint at the end of main() and read cycles_switch and
+// cycles_yield_to. Build with MODEL_FLAGS = -mlarge in the Makefile to measure the large model.
+
+#include <msp430.h> 
+#include <stdint.h>
+
+#include <cothread.h>
+
+#define ROUND_TRIPS 100 // Keeps the total below the 16-bit timer range
+
+stack_t alt_stack[64];
+
+cothread_t home_thread; // Home thread object
+cothread_t alt_thread;  // Alternate thread object
+
+volatile uint16_t cycles_switch;    // Cycles per cothread_switch()
+volatile uint16_t cycles_yield_to;  // Cycles per cothread_yield_to()
+
+static volatile uint8_t use_fast_path;
+
+//--------------------------------------------------------------------------------------------------
+int alt_thread_func(void){
+    while(1){
+        if(use_fast_path){
+            cothread_yield_to(&home_thread);
+        }else{
+            cothread_switch(&home_thread);
+        }
+    }
+    return(0);
+}
+
+//--------------------------------------------------------------------------------------------------
+static uint16_t measure(uint8_t fast_path){
+    uint16_t start, i;
+    
+    use_fast_path = fast_path;
+    
+    start = TA0R;
+    for(i=0; i<ROUND_TRIPS; i++){
+        if(fast_path){
+            cothread_yield_to(&alt_thread);
+        }else{
+            cothread_switch(&alt_thread);
+        }
+    }
+    return((uint16_t)(TA0R - start) / (2*ROUND_TRIPS));
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(void) {
+    WDTCTL = WDTPW | WDTHOLD; // Stop watchdog timer
+    
+    // Free-running timer clocked by SMCLK
+    TA0CTL = TASSEL__SMCLK | MC__CONTINUOUS | TACLR;
+    
+    cothread_init(&home_thread);
+    
+    alt_thread.alt_stack = alt_stack;
+    alt_thread.alt_stack_size = sizeof(alt_stack);
+    alt_thread.co_exit = &home_thread;
+    cothread_create(&alt_thread,alt_thread_func);
+    
+    // The first switch starts the thread. Don't count it.
+    cothread_switch(&alt_thread);
+    
+    cycles_switch = measure(0);
+    cycles_yield_to = measure(1);
+    
+    __no_operation(); // Breakpoint here
+    while(1);
+    
+    return(0);
+}
@@ -0,0 +1,92 @@
+// Compares the cost of the generic FIFO_t functions with a FIFO_DECLARE() FIFO in CPU cycles.
+// Timer A0 counts SMCLK, which runs from the same clock as MCLK after reset. Each result is the
+// average number of cycles per call, with the cost of an empty loop subtracted.
+// Run it in the debugger, stop at the breakpoint at the end of main() and read the cycles_* results.
+// Build with MODEL_FLAGS = -mlarge in the Makefile to measure the large model.
+// The host test in modules/emulate/fifo_pow2_test.c checks that both behave the same.
+
+#include <msp430.h>
+#include <stdint.h>
+
+#include <fifo.h>
+#include <fifo_pow2.h>
+
+#define FIFO_SIZE   64
+#define CALLS       (FIFO_SIZE/8) // 8-byte writes must not fill the FIFO
+
+uint8_t fifo_buf[FIFO_SIZE+1]; // FIFO_t always leaves one byte empty
+FIFO_t Fifo;
+
+FIFO_DECLARE(Pow2FIFO, FIFO_SIZE)
+
+typedef struct{
+    volatile uint16_t fifo_t;   // Generic FIFO_t function
+    volatile uint16_t pow2;     // FIFO_DECLARE() function
+} result_t;
+
+result_t cycles_write1;     // fifo_write() 1 byte vs. name_push()
+result_t cycles_read1;      // fifo_read() 1 byte vs. name_pop()
+result_t cycles_write2;     // fifo_write() 2 bytes vs. name_push16()
+result_t cycles_read2;      // fifo_read() 2 bytes vs. name_pop16()
+result_t cycles_write8;     // fifo_write() vs. name_write() with 8 bytes
+result_t cycles_read8;      // fifo_read() vs. name_read() with 8 bytes
+
+static volatile uint8_t src_byte = 0x55;
+static volatile uint16_t src_word = 0x1234;
+static uint8_t src_buf[8];
+static uint8_t dst_buf[8];
+
+static uint16_t loop_overhead;
+
+//--------------------------------------------------------------------------------------------------
+#define MEASURE(expr) ({ \
+    uint16_t start, i; \
+    start = TA0R; \
+    for(i=0; i<CALLS; i++){ \
+        expr; \
+    } \
+    (uint16_t)((uint16_t)(TA0R - start) - loop_overhead) / CALLS; \
+})
+
+//--------------------------------------------------------------------------------------------------
+int main(void) {
+    uint8_t b;
+    uint16_t w;
+    
+    WDTCTL = WDTPW | WDTHOLD; // Stop watchdog timer
+    
+    // Free-running timer clocked by SMCLK
+    TA0CTL = TASSEL__SMCLK | MC__CONTINUOUS | TACLR;
+    
+    fifo_init(&Fifo, fifo_buf, sizeof(fifo_buf));
+    Pow2FIFO_init();
+    
+    loop_overhead = 0;
+    loop_overhead = MEASURE(__no_operation()) * CALLS;
+    
+    // Start somewhere other than 0 so that some of the calls wrap around
+    fifo_write(&Fifo, src_buf, 5);
+    fifo_read(&Fifo, dst_buf, 5);
+    Pow2FIFO_write(src_buf, 5);
+    Pow2FIFO_read(dst_buf, 5);
+    
+    cycles_write1.fifo_t = MEASURE(b = src_byte; fifo_write(&Fifo, &b, 1));
+    cycles_read1.fifo_t = MEASURE(fifo_read(&Fifo, &b, 1));
+    cycles_write1.pow2 = MEASURE(Pow2FIFO_push(src_byte));
+    cycles_read1.pow2 = MEASURE(Pow2FIFO_pop(&b));
+    
+    cycles_write2.fifo_t = MEASURE(w = src_word; fifo_write(&Fifo, &w, 2));
+    cycles_read2.fifo_t = MEASURE(fifo_read(&Fifo, &w, 2));
+    cycles_write2.pow2 = MEASURE(Pow2FIFO_push16(src_word));
+    cycles_read2.pow2 = MEASURE(Pow2FIFO_pop16(&w));
+    
+    cycles_write8.fifo_t = MEASURE(fifo_write(&Fifo, src_buf, 8));
+    cycles_read8.fifo_t = MEASURE(fifo_read(&Fifo, dst_buf, 8));
+    cycles_write8.pow2 = MEASURE(Pow2FIFO_write(src_buf, 8));
+    cycles_read8.pow2 = MEASURE(Pow2FIFO_read(dst_buf, 8));
+    
+    __no_operation(); // Breakpoint here
+    while(1);
+    
+    return(0);
+}
@@ -264,11 +264,7 @@ ISR(BUT_TIMER_ISR_VECTOR){
             break;
     }
     
-    if(event_Pending()){
-        // Exit LPM0-3
-        __bic_SR_register_on_exit(LPM3_bits);
-        __no_operation();
-    }
+    EVENT_WAKE_ON_EXIT();
 }
 
 ///\endcond
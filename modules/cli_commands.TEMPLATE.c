@@ -1,7 +1,16 @@
 
 #include <stdio.h>
+#include <string.h>
 #include "cli_commands.h"
 
+#if CLI_EVENT_STATS
+    #include "event_queue.h"
+#endif
+
+#if CLI_STACKMON
+    #include "cothread.h"
+#endif
+
 //==================================================================================================
 // Device-specific output functions
 //==================================================================================================
@@ -49,3 +58,61 @@ int cmdArgList(uint16_t argc, char *argv[]){
     return(0);
 }
 
+#if CLI_EVENT_STATS
+//--------------------------------------------------------------------------------------------------
+static void print_timing(char *label, const event_timing_t *t, uint32_t count){
+    uint8_t i;
+    printf("  %s min/avg/max: %u/%lu/%u\r\n", label, t->min, (unsigned long)(t->sum/count), t->max);
+    printf("  %s histogram:", label);
+    for(i=0;i<EVENT_STATS_HIST_BINS;i++){
+        if(t->hist[i]){
+            printf(" <%lu:%u", 1UL << i, t->hist[i]);
+        }
+    }
+    cli_puts("\r\n");
+}
+
+// Prints the event queue dispatch statistics. (Requires EVENT_QUEUE_STATS = 1)
+// "evstats reset" clears them.
+int cmdEventStats(uint16_t argc, char *argv[]){
+    const event_stats_t *stats;
+    uint8_t idx;
+    
+    if((argc > 1) && (strcmp(argv[1], "reset") == 0)){
+        event_ResetStats();
+        return(0);
+    }
+    
+    for(idx=0; (stats = event_GetStats(idx)) != NULL; idx++){
+        printf("%p: %lu calls\r\n", (void*)stats->fptr, (unsigned long)stats->count);
+        print_timing("latency", &stats->latency, stats->count);
+        print_timing("runtime", &stats->runtime, stats->count);
+    }
+    
+    if(idx == 0){
+        cli_puts("No event statistics\r\n");
+    }
+    return(0);
+}
+#endif
+
+#if CLI_STACKMON
+//--------------------------------------------------------------------------------------------------
+// Prints the peak usage of every stack registered with stackmon_register() or
+// stackmon_register_main()
+int cmdStack(uint16_t argc, char *argv[]){
+    stackmon_t *mon;
+    
+    stackmon_sample_all();
+    
+    for(mon = stackmon_list(); mon; mon = mon->next){
+        printf("%s: %u of %u bytes used\r\n", mon->name, (unsigned)(mon->size - mon->min_unused),
+                (unsigned)mon->size);
+    }
+    
+    if(stackmon_list() == NULL){
+        cli_puts("No stacks registered\r\n");
+    }
+    return(0);
+}
+#endif
@@ -16,13 +16,35 @@
 // Maximum number of arguments in a command (including command).
 #define CLI_MAX_ARGC    5
 
+// If set to 1, adds the "evstats" command. (Requires the event_queue module with EVENT_QUEUE_STATS = 1)
+#define CLI_EVENT_STATS 0
+
+// If set to 1, adds the "stack" command. (Requires the cothread module)
+#define CLI_STACKMON    0
+
+#if CLI_EVENT_STATS
+    #define CMD_EVSTATS {"evstats", cmdEventStats},
+#else
+    #define CMD_EVSTATS
+#endif
+
+#if CLI_STACKMON
+    #define CMD_STACK   {"stack"  , cmdStack     },
+#else
+    #define CMD_STACK
+#endif
+
 // Table of commands: {"command_word" , function_name }
 // Command words MUST be in alphabetical (ascii) order!! (A-Z then a-z) if using binary search
-#define CMDTABLE    {"args"  , cmdArgList  },\
-                    {"hi"    , cmdHello    }
+#define CMDTABLE    {"args"   , cmdArgList   },\
+                    CMD_EVSTATS\
+                    {"hi"     , cmdHello     },\
+                    CMD_STACK
 
 // Custom command function prototypes:
 int cmdArgList(uint16_t argc, char *argv[]);
+int cmdEventStats(uint16_t argc, char *argv[]);
 int cmdHello(uint16_t argc, char *argv[]);
+int cmdStack(uint16_t argc, char *argv[]);
 
 #endif
@@ -90,11 +90,26 @@
  
 static cothread_t *CurrentThread;
 static int ThreadRetval;
+static void (*OverflowHandler)(cothread_t *thread);
+
+//--------------------------------------------------------------------------------------------------
+// Called before CurrentThread switches out. Checks that it did not overflow its stack.
+static void check_guard(void){
+    if(CurrentThread->guard && (*CurrentThread->guard != COTHREAD_GUARD_WORD)){
+        __disable_interrupt();
+        if(OverflowHandler){
+            OverflowHandler(CurrentThread);
+        }
+        // Can't continue with a corrupted stack
+        while(1);
+    }
+}
 //--------------------------------------------------------------------------------------------------
 void cothread_init(cothread_t *home_thread){
     home_thread->co_exit = NULL;
     home_thread->alt_stack = NULL;
     home_thread->alt_stack_size = 1;
+    home_thread->guard = NULL;
     home_thread->m_state.valid = 1;
     
     CurrentThread = home_thread;
@@ -109,6 +124,7 @@ void cothread_create(cothread_t *thread, int (*func) (void)){
     // Throw it into a variable that wont be referenced via the stack.
     // (thread becomes CurrentThread after the setjmp gets longjumped to)
     thread->func_start = func;
+    thread->guard = NULL;
     
     // Save interrupt state and disable interrupts when creating the thread context
     sr_state = __get_SR_register();
@@ -157,6 +173,8 @@ int cothread_switch(cothread_t *dest_thread){
     
     if(!(dest_thread->m_state.valid)) return(-1); // dest_thread is not valid. Don't switch
     
+    check_guard();
+    
     // save the current state
     sr_state = __get_SR_register();
     __disable_interrupt();
@@ -177,10 +195,30 @@ int cothread_switch(cothread_t *dest_thread){
     return(ThreadRetval);
 }
 
+//--------------------------------------------------------------------------------------------------
+int cothread_yield_to(cothread_t *dest_thread){
+    cothread_t *old_current = CurrentThread;
+    
+    if(dest_thread == CurrentThread) return(-1); // already in the dest_thread. nothing to do
+    
+    if(!(dest_thread->m_state.valid)) return(-1); // dest_thread is not valid. Don't switch
+    
+    check_guard();
+    
+    CurrentThread = dest_thread;
+    ThreadRetval = 0;
+    ct_swap(old_current->m_state.env, dest_thread->m_state.env);
+    // Other thread will switch back here later
+    
+    return(ThreadRetval);
+}
+
 //--------------------------------------------------------------------------------------------------
 void cothread_exit(int retval){
     // exit only if it has a valid exit destination
     if(CurrentThread->co_exit){
+        check_guard();
+        
         // Mark this thread as invalid
         CurrentThread->m_state.valid = 0;
         
@@ -192,6 +230,11 @@ void cothread_exit(int retval){
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+void cothread_set_overflow_handler(void (*handler)(cothread_t *thread)){
+    OverflowHandler = handler;
+}
+
 //--------------------------------------------------------------------------------------------------
 #define LFSR_INIT    0x0001
 static uint16_t lfsr16(uint16_t lfsr){
@@ -231,6 +274,102 @@ size_t stackmon_get_unused(stack_t *stack){
     return(i*2);
 }
 
+//--------------------------------------------------------------------------------------------------
+// Stacks registered for stackmon_sample_all()
+static stackmon_t *StackmonList;
+
+// Linker script symbols (msp430-elf)
+extern uint8_t end;     // End of .bss and .noinit
+extern uint8_t __stack; // Initial stack pointer
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_fill(stack_t *stack, size_t stack_size){
+    size_t i;
+    
+    stack_size = stack_size/sizeof(stack_t);
+    for(i=0;i<stack_size;i++){
+        stack[i] = STACKMON_FILL_WORD;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t stackmon_get_unused_fast(stack_t *stack, size_t stack_size){
+    size_t lo, hi, mid;
+    
+    // Find the first word from the base that was overwritten
+    lo = 0;
+    hi = stack_size/sizeof(stack_t);
+    while(lo < hi){
+        mid = lo + (hi - lo)/2;
+        if(stack[mid] == STACKMON_FILL_WORD){
+            lo = mid + 1;
+        }else{
+            hi = mid;
+        }
+    }
+    
+    return(lo*sizeof(stack_t));
+}
+
+//--------------------------------------------------------------------------------------------------
+static void stackmon_add(stackmon_t *mon, const char *name, stack_t *stack, size_t stack_size){
+    stackmon_t *m;
+    
+    mon->name = name;
+    mon->stack = stack;
+    mon->size = stack_size;
+    mon->min_unused = stack_size;
+    
+    // A monitor that is registered again (for a reused stack) is already in the list
+    for(m = StackmonList; m; m = m->next){
+        if(m == mon) return;
+    }
+    mon->next = StackmonList;
+    StackmonList = mon;
+}
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_register(stackmon_t *mon, const char *name, stack_t *stack, size_t stack_size){
+    stackmon_fill(stack, stack_size);
+    stackmon_add(mon, name, stack, stack_size);
+}
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_register_main(stackmon_t *mon, const char *name){
+    uintptr_t base, top, sp;
+    volatile stack_t *p;
+    
+    base = ((uintptr_t)&end + sizeof(stack_t) - 1) & ~(uintptr_t)(sizeof(stack_t) - 1);
+    top = (uintptr_t)&__stack;
+    sp = (uintptr_t)__get_SP_register() & ~(uintptr_t)(sizeof(stack_t) - 1);
+    
+    // Only the part below the frames that are in use can be filled. This is done inline, since the
+    // frame of a called function would sit in the region that is being filled. The volatile
+    // pointer keeps the compiler from turning the loop into a call to memset().
+    for(p = (stack_t*)base; (uintptr_t)p < sp; p++){
+        *p = STACKMON_FILL_WORD;
+    }
+    stackmon_add(mon, name, (stack_t*)base, top - base);
+}
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_sample_all(void){
+    stackmon_t *mon;
+    size_t unused;
+    
+    for(mon = StackmonList; mon; mon = mon->next){
+        unused = stackmon_get_unused_fast(mon->stack, mon->size);
+        if(unused < mon->min_unused){
+            mon->min_unused = unused;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+stackmon_t* stackmon_list(void){
+    return(StackmonList);
+}
+
 //--------------------------------------------------------------------------------------------------
 ///\}
 ///\}
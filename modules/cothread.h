@@ -132,6 +132,12 @@
 
 typedef uintptr_t stack_t __attribute__ ((aligned (__BIGGEST_ALIGNMENT__)));
 
+/// Value of the stack guard words planted by \ref MOD_COTHREAD_POOL
+#define COTHREAD_GUARD_WORD ((stack_t)0xA55AC33CUL)
+
+/// Value that stackmon_fill() fills unused stack space with
+#define STACKMON_FILL_WORD ((stack_t)0xCDCDCDCDUL)
+
 typedef struct{
     ct_jmp_buf env __attribute__ ((aligned (__BIGGEST_ALIGNMENT__)));
     uint8_t valid;
@@ -142,9 +148,19 @@ typedef struct cothread{
     stack_t *alt_stack; ///< Pointer to the base of an alternate stack.
     size_t alt_stack_size; ///< The size (in bytes) of the stack which 'alt_stack' points to.
     int (*func_start) (void); ///< Stores the startup function pointer. Do not access.
+    stack_t *guard; ///< Guard word that is checked whenever the thread switches out. NULL if unused. Set by \ref MOD_COTHREAD_POOL.
     m_state_t m_state; ///< This element stores the machine state of the process. Its definition should be treated as opaque
 } cothread_t __attribute__ ((aligned (__BIGGEST_ALIGNMENT__)));
 
+/// Registered stack for stackmon_sample_all(). All members are read-only.
+typedef struct stackmon{
+    const char *name;       ///< Name of the stack
+    stack_t *stack;         ///< Base (lowest address) of the stack
+    size_t size;            ///< Size of the stack in bytes
+    size_t min_unused;      ///< Fewest unused bytes seen by stackmon_sample_all()
+    struct stackmon *next;
+} stackmon_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * \brief Initializes the home thread object
@@ -191,6 +207,24 @@ void cothread_create(cothread_t *thread, int (*func) (void));
  **/
 int cothread_switch(cothread_t *dest_thread);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Switch to a different context using the fast path
+ * 
+ * Works like cothread_switch(), but only the callee-saved registers are saved and interrupts are
+ * not disabled during the switch. Threads switched out with either function can be switched to
+ * with either function.
+ * 
+ * Unlike cothread_switch(), the interrupt enable state is not restored per thread. When a thread
+ * resumes, GIE is whatever it was in the thread that switched to it.
+ * 
+ * \param dest_thread    Pointer to the destination thread to switch to
+ * \retval 0        If the previous thread switched here normally
+ * \retval -1         If it was not possible to switch to \c dest_thread
+ * \retval other     Returns the exit value that the thread terminated with.
+ **/
+int cothread_yield_to(cothread_t *dest_thread);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * \brief Terminates the current thread
@@ -199,6 +233,21 @@ int cothread_switch(cothread_t *dest_thread);
  **/
 void cothread_exit(int retval);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Sets the function that is called when a stack overflow is detected
+ * 
+ * If a thread has a stack guard word (see \ref MOD_COTHREAD_POOL), it is checked every time the
+ * thread switches out or exits. If it was overwritten, \c handler is called with interrupts
+ * disabled from the overflowed thread, instead of switching. The thread's stack can not be trusted
+ * anymore so the handler should not return. Typically it logs the fault and resets the device.
+ * 
+ * If no handler is set, the CPU halts with interrupts disabled.
+ * 
+ * \param handler Overflow handler. Receives the thread that overflowed.
+ **/
+void cothread_set_overflow_handler(void (*handler)(cothread_t *thread));
+
 //--------------------------------------------------------------------------------------------------
 /**
  * \name Stack Monitor Functions
@@ -208,6 +257,10 @@ void cothread_exit(int retval);
  * sequence. As the stack is used, these values are overwritten. The stackmon_get_unused() function
  * determines how many bytes of the pseudorandom sequence remain.
  * 
+ * stackmon_fill() and stackmon_get_unused_fast() use a constant pattern instead, which allows a
+ * binary search. Stacks registered with stackmon_register() or stackmon_register_main() can be
+ * sampled together with stackmon_sample_all().
+ * 
  * \{
  **/
  
@@ -227,6 +280,65 @@ void stackmon_init(stack_t *stack, size_t stack_size);
  **/
 size_t stackmon_get_unused(stack_t *stack);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Fill a stack with #STACKMON_FILL_WORD
+ * \details Use with stackmon_get_unused_fast(). This must be done \e prior to calling
+ * cothread_create()
+ * \param stack        Pointer to the allocated stack
+ * \param stack_size    The size of the stack in bytes
+ **/
+void stackmon_fill(stack_t *stack, size_t stack_size);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Determine how much of a stack filled by stackmon_fill() was untouched
+ * \details Binary searches for the highest point the stack has reached, so it only reads about
+ * log2(stack_size) words. It assumes that everything the stack has reached was overwritten. A word
+ * that happens to hold #STACKMON_FILL_WORD in a deep frame (an uninitialized local array for
+ * example) can make the result larger than it really is.
+ * \param stack        Pointer to the allocated stack
+ * \param stack_size    The size of the stack in bytes
+ * \return Number of bytes remaining in the stack.
+ **/
+size_t stackmon_get_unused_fast(stack_t *stack, size_t stack_size);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Fill an alternate stack and add it to the list sampled by stackmon_sample_all()
+ * \note This must be done \e prior to calling cothread_create()
+ * \details Registering the same \c mon again, for a stack that is being reused, only resets it.
+ * \param mon          Monitor object. Must stay valid.
+ * \param name         Name of the stack
+ * \param stack        Pointer to the allocated stack
+ * \param stack_size    The size of the stack in bytes
+ **/
+void stackmon_register(stackmon_t *mon, const char *name, stack_t *stack, size_t stack_size);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Fill the free part of the main C stack and add it to the list sampled by stackmon_sample_all()
+ * \details The main stack spans from the end of the \c .bss and \c .noinit sections up to the
+ * initial stack pointer. The part below the current stack pointer is filled, so call this as early
+ * as possible in main(). It can't be used if the application uses the heap.
+ * \param mon          Monitor object. Must stay valid.
+ * \param name         Name of the stack
+ **/
+void stackmon_register_main(stackmon_t *mon, const char *name);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Update the \c min_unused of all registered stacks
+ * \details Cheap enough to call periodically, for example from a timer event.
+ **/
+void stackmon_sample_all(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Returns the first registered stack. Follow \c next for the others.
+ **/
+stackmon_t* stackmon_list(void);
+
 ///\}
 //--------------------------------------------------------------------------------------------------
 #ifdef __cplusplus
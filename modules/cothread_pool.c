@@ -0,0 +1,196 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_COTHREAD_POOL
+* \{
+**/
+
+/**
+* \file
+* \brief Code for \ref MOD_COTHREAD_POOL
+* \author Alex Mykyta 
+**/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <result.h>
+
+#include <cothread.h>
+#include "cothread_pool.h"
+#include <cothread_pool_config.h>
+
+#ifndef COTHREAD_POOL_STACKS
+    #define COTHREAD_POOL_STACKS        4
+#endif
+
+#ifndef COTHREAD_POOL_STACK_SIZE
+    #define COTHREAD_POOL_STACK_SIZE    256
+#endif
+
+#ifndef COTHREAD_POOL_GUARD_WORDS
+    #define COTHREAD_POOL_GUARD_WORDS   2
+#endif
+
+#if(COTHREAD_POOL_GUARD_WORDS < 1)
+    #error "COTHREAD_POOL_GUARD_WORDS must be at least 1"
+#endif
+
+#if(COTHREAD_POOL_STACKS > 255)
+    #error "COTHREAD_POOL_STACKS must be less than 256"
+#endif
+
+// Stack size rounded up so that every stack in the arena stays aligned
+#define STACK_BYTES (((COTHREAD_POOL_STACK_SIZE + __BIGGEST_ALIGNMENT__ - 1) / __BIGGEST_ALIGNMENT__) \
+                     * __BIGGEST_ALIGNMENT__)
+
+//==================================================================================================
+// Internal Variables
+//==================================================================================================
+
+static uint8_t Arena[COTHREAD_POOL_STACKS][STACK_BYTES] __attribute__ ((aligned (__BIGGEST_ALIGNMENT__)));
+
+// Thread that was last given each stack. NULL if never used or released.
+static cothread_t *Owner[COTHREAD_POOL_STACKS];
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// A stack is free once its thread has exited. The thread object may also have been reused since,
+// either for another pooled stack or with cothread_create(). The thread object is read here until
+// the stack is reused or released, so it has to stay valid until then.
+static bool StackFree(uint8_t idx){
+    cothread_t *owner = Owner[idx];
+    
+    if(owner == NULL){
+        return(true);
+    }
+    if(owner->m_state.valid == 0){
+        return(true);
+    }
+    if(owner->alt_stack != (stack_t*)Arena[idx]){
+        return(true);
+    }
+    return(false);
+}
+
+//==================================================================================================
+// Functions
+//==================================================================================================
+
+void cothread_pool_init(void){
+    uint8_t i;
+    
+    for(i=0; i<COTHREAD_POOL_STACKS; i++){
+        Owner[i] = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t cothread_pool_create(cothread_t *thread, int (*func)(void), stackmon_t *mon, const char *name){
+    stack_t *stack;
+    uint8_t i, j;
+    
+    for(i=0; i<COTHREAD_POOL_STACKS; i++){
+        if(StackFree(i)){
+            break;
+        }
+    }
+    if(i == COTHREAD_POOL_STACKS){
+        return(RES_FULL);
+    }
+    
+    // The stack grows down towards the guard words at its base
+    stack = (stack_t*)Arena[i];
+    for(j=0; j<COTHREAD_POOL_GUARD_WORDS; j++){
+        stack[j] = COTHREAD_GUARD_WORD;
+    }
+    
+    // Fill the rest for the stack monitor. Guard words are not part of the monitored area.
+    if(mon){
+        stackmon_register(mon, name, &stack[COTHREAD_POOL_GUARD_WORDS],
+                          STACK_BYTES - COTHREAD_POOL_GUARD_WORDS*sizeof(stack_t));
+    }else{
+        stackmon_fill(&stack[COTHREAD_POOL_GUARD_WORDS],
+                      STACK_BYTES - COTHREAD_POOL_GUARD_WORDS*sizeof(stack_t));
+    }
+    
+    Owner[i] = thread;
+    thread->alt_stack = stack;
+    thread->alt_stack_size = STACK_BYTES;
+    cothread_create(thread, func);
+    
+    // Overflows reach the top guard word first
+    thread->guard = &stack[COTHREAD_POOL_GUARD_WORDS - 1];
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t cothread_pool_release(cothread_t *thread){
+    uint8_t i;
+    
+    if(thread->m_state.valid){
+        return(RES_PARAMERR);
+    }
+    
+    for(i=0; i<COTHREAD_POOL_STACKS; i++){
+        if(Owner[i] == thread){
+            Owner[i] = NULL;
+            return(RES_OK);
+        }
+    }
+    return(RES_PARAMERR);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool cothread_pool_check(cothread_t *thread){
+    uint8_t j;
+    
+    for(j=0; j<COTHREAD_POOL_GUARD_WORDS; j++){
+        if(thread->alt_stack[j] != COTHREAD_GUARD_WORD){
+            return(false);
+        }
+    }
+    return(true);
+}
+
+//--------------------------------------------------------------------------------------------------
+uint8_t cothread_pool_available(void){
+    uint8_t i;
+    uint8_t count = 0;
+    
+    for(i=0; i<COTHREAD_POOL_STACKS; i++){
+        if(StackFree(i)){
+            count++;
+        }
+    }
+    return(count);
+}
+
+///\}
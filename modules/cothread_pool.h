@@ -0,0 +1,146 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_COTHREAD_POOL Thread Stack Pool
+* \brief Fixed-size cothread stacks with overflow guards
+* \author Alex Mykyta 
+*
+* Hands out stacks of \c COTHREAD_POOL_STACK_SIZE bytes from one arena so that threads do not need
+* their own stack arrays. A stack goes back to the pool once its thread has exited, either by
+* returning or through cothread_exit(). It is reused by the next cothread_pool_create().
+*
+* The pool checks whether a thread has exited through its thread object, so the \c cothread_t must
+* stay valid until its stack has been handed to another thread. A thread object that goes out of
+* scope or is freed before then must first be detached from its stack using
+* cothread_pool_release().
+*
+* The bottom \c COTHREAD_POOL_GUARD_WORDS words of each stack are filled with
+* #COTHREAD_GUARD_WORD. \ref MOD_COTHREADS checks the top guard word whenever the thread switches
+* out or exits, and calls the handler set with cothread_set_overflow_handler() if the thread has
+* overflowed into it.
+*
+* The rest of the stack is filled with #STACKMON_FILL_WORD, so its peak usage can be tracked by
+* passing a \c stackmon_t to cothread_pool_create(). It then shows up in stackmon_sample_all() like
+* any other registered stack. (stackmon_register() can't be used on a pooled stack since it would
+* overwrite the guard words.)
+*
+* \code
+*     int worker(void){
+*         // ...
+*         return(0);
+*     }
+*     
+*     cothread_t worker_thread;
+*     stackmon_t worker_mon;
+*     
+*     worker_thread.co_exit = &home_thread;
+*     if(cothread_pool_create(&worker_thread, worker, &worker_mon, "worker") == RES_OK){
+*         cothread_switch(&worker_thread);
+*     }
+* \endcode
+*
+* \ref MOD_COTHREAD_POOL also requires the following modules:
+*    - \ref MOD_COTHREADS
+*
+* \{
+**/
+
+/**
+* \file
+* \brief Include file for \ref MOD_COTHREAD_POOL
+* \author Alex Mykyta 
+**/
+
+#ifndef COTHREAD_POOL_H
+#define COTHREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <result.h>
+
+#include <cothread.h>
+
+//==================================================================================================
+// Function Prototypes
+//==================================================================================================
+
+/**
+* \brief Marks all stacks in the pool as free
+* \details Must be called before any other pool function
+**/
+void cothread_pool_init(void);
+
+/**
+* \brief Creates a thread on a stack from the pool
+* \param [in] thread Thread object. Its \c co_exit element must be set beforehand.
+* \param [in] func Entry function for the new thread
+* \param [in] mon Monitor for the part of the stack above the guard words. May be \c NULL. It is
+*   registered with \ref MOD_COTHREADS the same way as stackmon_register() does. Must stay valid.
+* \param [in] name Name of the stack in \c mon
+* \retval RES_OK    Thread created
+* \retval RES_FULL    All stacks are used by threads that have not exited yet
+* \details Works like cothread_create(), except that \c alt_stack, \c alt_stack_size and \c guard
+*   are set by the pool. Must not be called from an ISR.
+*   
+*   \c thread must stay valid until its stack is reused, or until it is passed to
+*   cothread_pool_release().
+**/
+RES_t cothread_pool_create(cothread_t *thread, int (*func)(void), stackmon_t *mon, const char *name);
+
+/**
+* \brief Detaches an exited thread from its pooled stack
+* \details After this, the pool no longer accesses \c thread, so the object can go out of scope or
+*   be freed. Must not be called from an ISR.
+* \param [in] thread Thread created with cothread_pool_create()
+* \retval RES_OK    Stack returned to the pool
+* \retval RES_PARAMERR    The thread has not exited yet, or it does not own a pooled stack
+**/
+RES_t cothread_pool_release(cothread_t *thread);
+
+/**
+* \brief Checks all guard words of a pooled thread's stack
+* \param [in] thread Thread created with cothread_pool_create()
+* \retval true    Guard words are intact
+* \retval false    The thread has overflowed its stack
+**/
+bool cothread_pool_check(cothread_t *thread);
+
+/**
+* \brief Returns the number of stacks that are free
+**/
+uint8_t cothread_pool_available(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+///\}
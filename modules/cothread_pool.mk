@@ -0,0 +1,4 @@
+
+########################################### Module Setup ###########################################
+MODULE_SOURCES += cothread_pool.c
+REQUIRED_MODULES += cothread
@@ -0,0 +1,36 @@
+/**
+* \addtogroup MOD_COTHREAD_POOL
+* \{
+**/
+
+/**
+* \file
+* \brief Configuration include file for \ref MOD_COTHREAD_POOL
+* \author Alex Mykyta 
+**/
+
+#ifndef COTHREAD_POOL_CONFIG_H
+#define COTHREAD_POOL_CONFIG_H
+
+//==================================================================================================
+/// \name Configuration
+/// Configuration defines for the \ref MOD_COTHREAD_POOL module
+/// \{
+//==================================================================================================
+
+/// Number of stacks in the pool
+#define COTHREAD_POOL_STACKS        4    ///< \hideinitializer
+
+/// Size of each stack in bytes, including the guard words
+#define COTHREAD_POOL_STACK_SIZE    256    ///< \hideinitializer
+
+/// Number of guard words at the bottom of each stack
+#define COTHREAD_POOL_GUARD_WORDS   2    ///< \hideinitializer
+/**<    Only the top guard word is checked on every switch. cothread_pool_check() checks all of them,
+*       which also catches stack frames that skipped over the top word.
+**/
+
+///\}
+    
+#endif
+///\}
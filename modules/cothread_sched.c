@@ -0,0 +1,297 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_COTHREAD_SCHED
+* \{
+**/
+
+/**
+* \file
+* \brief Code for \ref MOD_COTHREAD_SCHED
+* \author Alex Mykyta 
+**/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <result.h>
+#include <atomic.h>
+#include <msp430_xc.h>
+
+#include <cothread.h>
+#include "cothread_sched.h"
+#include <cothread_sched_config.h>
+
+#ifndef COTHREAD_PRIO_LEVELS
+    #define COTHREAD_PRIO_LEVELS    4
+#endif
+
+#ifndef COTHREAD_IDLE_SLEEP
+    #define COTHREAD_IDLE_SLEEP     1
+#endif
+
+#ifndef COTHREAD_IDLE_LPM_BITS
+    #define COTHREAD_IDLE_LPM_BITS  LPM0_bits
+#endif
+
+#if((COTHREAD_PRIO_LEVELS < 1) || (COTHREAD_PRIO_LEVELS > 8))
+    #error "COTHREAD_PRIO_LEVELS must be between 1 and 8"
+#endif
+
+//==================================================================================================
+// Internal Variables
+//==================================================================================================
+
+enum{
+    TASK_READY = 0, // In a ready queue
+    TASK_RUNNING,
+    TASK_BLOCKED,
+    TASK_ENDED
+};
+
+// One FIFO of ready threads per priority level. Linked through cothread_task_t.next
+typedef struct{
+    cothread_task_t *head;
+    cothread_task_t *tail;
+} ready_queue_t;
+
+static ready_queue_t ReadyQueue[COTHREAD_PRIO_LEVELS];
+static uint8_t ReadyMask;       // Bit n is set if ReadyQueue[n] is not empty
+static cothread_t HomeThread;
+static cothread_task_t *Current; // NULL while in HomeThread
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// Adds a thread to the back of its ready queue. Must be called with interrupts disabled.
+static void ReadyPush(cothread_task_t *task){
+    ready_queue_t *q = &ReadyQueue[task->prio];
+    
+    task->state = TASK_READY;
+    task->next = NULL;
+    if(q->tail){
+        q->tail->next = task;
+    }else{
+        q->head = task;
+    }
+    q->tail = task;
+    ReadyMask |= (1 << task->prio);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Removes the next thread to run from the ready queues. Must be called with interrupts disabled.
+static cothread_task_t* ReadyPop(void){
+    ready_queue_t *q;
+    cothread_task_t *task;
+    int8_t prio;
+    
+    if(ReadyMask == 0){
+        return(NULL);
+    }
+    
+    prio = COTHREAD_PRIO_LEVELS - 1;
+    while(!(ReadyMask & (1 << prio))){
+        prio--;
+    }
+    
+    q = &ReadyQueue[prio];
+    task = q->head;
+    q->head = task->next;
+    if(q->head == NULL){
+        q->tail = NULL;
+        ReadyMask &= ~(1 << prio);
+    }
+    
+    task->state = TASK_RUNNING;
+    return(task);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Switches from the running thread to next, or to HomeThread if next is NULL.
+// All scheduled threads run with interrupts enabled, so the fast path can be used.
+static void SwitchTo(cothread_task_t *next){
+    Current = next;
+    if(next){
+        cothread_yield_to(&next->thread);
+    }else{
+        cothread_yield_to(&HomeThread);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+static int ThreadEntry(void){
+    int ret;
+    
+    // cothread_create() starts threads with interrupts disabled
+    __enable_interrupt();
+    
+    ret = Current->func();
+    
+    // Returning switches to HomeThread through co_exit
+    Current->state = TASK_ENDED;
+    Current = NULL;
+    return(ret);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void SchedIdle(void){
+#if(COTHREAD_IDLE_SLEEP == 1)
+    __disable_interrupt();
+    __no_operation();
+    
+    if(ReadyMask == 0){
+        // Setting GIE and the LPM bits in one instruction closes the window where an ISR could wake
+        // a thread between the check above and going to sleep.
+        __bis_SR_register(COTHREAD_IDLE_LPM_BITS | GIE);
+        __no_operation();
+    }
+    
+    __enable_interrupt();
+#else
+    onThreadIdle();
+#endif
+}
+
+//==================================================================================================
+// Functions
+//==================================================================================================
+
+void cothread_sched_init(void){
+    uint8_t i;
+    
+    for(i=0; i<COTHREAD_PRIO_LEVELS; i++){
+        ReadyQueue[i].head = NULL;
+        ReadyQueue[i].tail = NULL;
+    }
+    ReadyMask = 0;
+    Current = NULL;
+    cothread_init(&HomeThread);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t cothread_start(cothread_task_t *task, int (*func)(void), stack_t *stack, size_t stack_size,
+                     uint8_t prio){
+    if(prio >= COTHREAD_PRIO_LEVELS){
+        return(RES_PARAMERR);
+    }
+    
+    task->func = func;
+    task->prio = prio;
+    task->wake_pending = false;
+    task->waiting = false;
+    task->release_latched = false;
+    task->thread.co_exit = &HomeThread;
+    task->thread.alt_stack = stack;
+    task->thread.alt_stack_size = stack_size;
+    cothread_create(&task->thread, ThreadEntry);
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        ReadyPush(task);
+    }
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_sched_run(void){
+    cothread_task_t *next;
+    
+    while(1){
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            next = ReadyPop();
+        }
+        
+        if(next){
+            // Runs until no threads are ready, then switches back here
+            SwitchTo(next);
+        }else{
+            SchedIdle();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_yield(void){
+    cothread_task_t *self = Current;
+    cothread_task_t *next;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        ReadyPush(self);
+        next = ReadyPop();
+    }
+    
+    if(next != self){
+        SwitchTo(next);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_block(void){
+    cothread_task_t *self = Current;
+    cothread_task_t *next;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(self->wake_pending){
+            self->wake_pending = false;
+            self->release_latched = false;
+            return;
+        }
+        self->state = TASK_BLOCKED;
+        next = ReadyPop();
+    }
+    
+    // Resumes here once woken
+    SwitchTo(next);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_wake(cothread_task_t *task){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(task->state == TASK_BLOCKED){
+            ReadyPush(task);
+        }else if(task->state != TASK_ENDED){
+            // Running or waiting for its turn. Don't let its next cothread_block() miss this.
+            task->wake_pending = true;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+cothread_task_t* cothread_self(void){
+    return(Current);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool cothread_sched_pending(void){
+    if(ReadyMask){
+        return(true);
+    }else{
+        return(false);
+    }
+}
+
+///\}
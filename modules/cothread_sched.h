@@ -0,0 +1,214 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_COTHREAD_SCHED Thread Scheduler
+* \brief Round-robin scheduler for cooperative threads
+* \author Alex Mykyta 
+*
+* Keeps a ready queue of \ref MOD_COTHREADS threads so that threads do not need to know about each
+* other to share the CPU. A thread gives up the CPU with cothread_yield(), or waits with
+* cothread_block() until another thread or an ISR calls cothread_wake() on it.
+*
+* Each thread has a priority. The scheduler always switches to the oldest ready thread of the
+* highest priority level, so yielding, blocking and waking take the same time regardless of how
+* many threads exist. Threads of a lower level only run when no higher level thread is ready.
+*
+* When no threads are ready, the scheduler returns to the home thread that called
+* cothread_sched_run(). It then puts the CPU to sleep (or calls onThreadIdle()) until a thread is
+* woken. ISRs that wake threads must end with COTHREAD_WAKE_ON_EXIT().
+*
+* The scheduler owns the \ref MOD_COTHREADS home thread, so the application must not call
+* cothread_init() or cothread_switch() itself.
+*
+* \code
+*     stack_t rx_stack[64];
+*     cothread_task_t rx_task;
+*     
+*     int rx_thread(void){
+*         while(1){
+*             cothread_block(); // Sleep until the UART ISR calls cothread_wake(&rx_task)
+*             // ... process data
+*         }
+*         return(0);
+*     }
+*     
+*     int main(void){
+*         cothread_sched_init();
+*         cothread_start(&rx_task, rx_thread, rx_stack, sizeof(rx_stack), 1);
+*         cothread_sched_run(); // Does not return
+*     }
+* \endcode
+*
+* \ref MOD_COTHREAD_SCHED also requires the following modules:
+*    - \ref MOD_COTHREADS
+*
+* \{
+**/
+
+/**
+* \file
+* \brief Include file for \ref MOD_COTHREAD_SCHED
+* \author Alex Mykyta 
+**/
+
+#ifndef COTHREAD_SCHED_H
+#define COTHREAD_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <result.h>
+
+#include <cothread.h>
+
+//==================================================================================================
+// Macros
+//==================================================================================================
+
+/**
+* \brief Wakes the CPU from low-power mode when the ISR exits if a thread is ready
+* \details Call at the end of any ISR that calls cothread_wake(). It must be called from the ISR
+*   function itself and not from a function that the ISR calls.
+* \hideinitializer
+**/
+#define COTHREAD_WAKE_ON_EXIT() \
+    do{ \
+        if(cothread_sched_pending()){ \
+            __bic_SR_register_on_exit(LPM4_bits); \
+            __no_operation(); \
+        } \
+    }while(0)
+
+//==================================================================================================
+// Types
+//==================================================================================================
+
+/// Scheduled thread. All members are private.
+typedef struct cothread_task{
+    cothread_t thread;
+    int (*func)(void);
+    struct cothread_task *next; // Next thread in the same ready queue
+    uint8_t prio;
+    uint8_t state;
+    bool wake_pending;          // cothread_wake() was called while the thread was not blocked
+    struct cothread_task *wait_next; // Next thread in the same wait queue of \ref MOD_COTHREAD_SYNC
+    bool waiting;               // In a wait queue of \ref MOD_COTHREAD_SYNC
+    bool release_latched;       // wake_pending was set by the release from that wait queue
+} cothread_task_t;
+
+//==================================================================================================
+// Function Prototypes
+//==================================================================================================
+
+/**
+* \brief Initializes the scheduler
+* \details Must be called before any other scheduler function. Takes the place of cothread_init().
+**/
+void cothread_sched_init(void);
+
+/**
+* \brief Creates a thread and makes it ready to run
+* \param [in] task Thread object. Must stay valid until the thread returns.
+* \param [in] func Entry function of the thread
+* \param [in] stack Stack of the thread
+* \param [in] stack_size Size of \c stack in bytes
+* \param [in] prio Priority level. 0 is the lowest. Must be less than \c COTHREAD_PRIO_LEVELS.
+* \retval RES_OK    Thread created
+* \retval RES_PARAMERR    Invalid priority level
+* \details The thread first runs once the threads that are already ready have had their turn. When
+*   \c func returns, the thread ends and \c task can be reused.
+**/
+RES_t cothread_start(cothread_task_t *task, int (*func)(void), stack_t *stack, size_t stack_size,
+                     uint8_t prio);
+
+/**
+* \brief Runs the scheduler in the home thread
+* \details Switches to ready threads until none are left, then idles until one is woken. Does not
+*   return.
+**/
+void cothread_sched_run(void);
+
+/**
+* \brief Lets the other ready threads of the same or higher priority run
+* \details The calling thread goes to the back of its ready queue. If no other thread of the same or
+*   higher priority is ready, it continues right away. Must only be called from a scheduled thread.
+**/
+void cothread_yield(void);
+
+/**
+* \brief Suspends the calling thread until it is woken by cothread_wake()
+* \details If cothread_wake() was called on this thread since it last blocked, it returns right
+*   away, so a wakeup that arrives before the thread blocks is never lost. Must only be called from
+*   a scheduled thread.
+**/
+void cothread_block(void);
+
+/**
+* \brief Makes a blocked thread ready to run
+* \param [in] task Thread to wake
+* \details Can be called from ISRs and from other threads. The calling thread keeps running. If
+*   \c task is not blocked, its next call to cothread_block() returns right away.
+**/
+void cothread_wake(cothread_task_t *task);
+
+/**
+* \brief Returns the thread that is running, or \c NULL in the home thread
+**/
+cothread_task_t* cothread_self(void);
+
+/**
+* \brief Checks if any threads are ready to run
+* \retval true    At least one thread is ready
+* \retval false    No threads are ready
+**/
+bool cothread_sched_pending(void);
+
+//==================================================================================================
+// Events
+//==================================================================================================
+
+///\name Events
+///\{
+
+/**
+* \brief Scheduler idle event
+* \details Called repeatedly from the home thread while no threads are ready. Only used if
+*   \c COTHREAD_IDLE_SLEEP is set to 0.
+**/
+extern void onThreadIdle(void);
+
+///\}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+///\}
@@ -0,0 +1,4 @@
+
+########################################### Module Setup ###########################################
+MODULE_SOURCES += cothread_sched.c
+REQUIRED_MODULES += cothread
@@ -0,0 +1,41 @@
+/**
+* \addtogroup MOD_COTHREAD_SCHED
+* \{
+**/
+
+/**
+* \file
+* \brief Configuration include file for \ref MOD_COTHREAD_SCHED
+* \author Alex Mykyta 
+**/
+
+#ifndef COTHREAD_SCHED_CONFIG_H
+#define COTHREAD_SCHED_CONFIG_H
+
+//==================================================================================================
+/// \name Configuration
+/// Configuration defines for the \ref MOD_COTHREAD_SCHED module
+/// \{
+//==================================================================================================
+
+/// Number of thread priority levels (1 to 8)
+#define COTHREAD_PRIO_LEVELS    4    ///< \hideinitializer
+/**<    Ready threads in a higher level always run before any thread in a lower level. Threads within
+*       a level take turns in the order they became ready.
+**/
+
+/// Idle policy of the scheduler
+#define COTHREAD_IDLE_SLEEP     1    ///< \hideinitializer
+/**<    0 = onThreadIdle() is called when no threads are ready. It must be provided by the
+*           application. \n
+*       1 = The CPU sleeps in COTHREAD_IDLE_LPM_BITS when no threads are ready. ISRs that wake
+*           threads must end with COTHREAD_WAKE_ON_EXIT().
+**/
+
+/// Low-power mode used by the built-in idle
+#define COTHREAD_IDLE_LPM_BITS  LPM0_bits    ///< \hideinitializer
+
+///\}
+    
+#endif
+///\}
@@ -29,6 +29,7 @@ typedef struct{
 
 int ct_setjmp (ct_jmp_buf env);
 __attribute__((__noreturn__)) void ct_longjmp (ct_jmp_buf env, int val);
+void ct_swap (ct_jmp_buf save_env, ct_jmp_buf load_env);
 
 
 #endif
@@ -0,0 +1,319 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_COTHREAD_SYNC
+* \{
+**/
+
+/**
+* \file
+* \brief Code for \ref MOD_COTHREAD_SYNC
+* \author Alex Mykyta 
+**/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <result.h>
+#include <atomic.h>
+
+#include <fifo.h>
+#include "cothread_sched.h"
+#include "cothread_sync.h"
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// Adds a thread to the back of a wait queue. Must be called with interrupts disabled.
+static void WaitqPush(cothread_waitq_t *q, cothread_task_t *task){
+    task->waiting = true;
+    task->wait_next = NULL;
+    if(q->tail){
+        q->tail->wait_next = task;
+    }else{
+        q->head = task;
+    }
+    q->tail = task;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Removes the first thread of a wait queue and wakes it. Returns it, or NULL if the queue was empty.
+// Must be called with interrupts disabled.
+static cothread_task_t* WaitqRelease(cothread_waitq_t *q){
+    cothread_task_t *task = q->head;
+    bool was_pending;
+    
+    if(task){
+        q->head = task->wait_next;
+        if(q->head == NULL){
+            q->tail = NULL;
+        }
+        task->waiting = false;
+        // If the thread is not blocked yet, the wakeup is latched. Remember whether this release is
+        // what set the latch so that WaitReleased() only consumes its own wakeup.
+        was_pending = task->wake_pending;
+        cothread_wake(task);
+        task->release_latched = !was_pending && task->wake_pending;
+    }
+    return(task);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void WaitqInit(cothread_waitq_t *q){
+    q->head = NULL;
+    q->tail = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Blocks until the calling thread has been released from the wait queue it is in. Other wakeups of
+// the thread are ignored.
+static void WaitReleased(cothread_task_t *self){
+    while(1){
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(!self->waiting){
+                // If the release landed while this thread was not blocked, its wakeup is still
+                // pending. Consume it so that the next unrelated cothread_block() doesn't return
+                // right away. A wakeup that was already pending belongs to someone else.
+                if(self->release_latched){
+                    self->release_latched = false;
+                    self->wake_pending = false;
+                }
+                return;
+            }
+        }
+        cothread_block();
+    }
+}
+
+//==================================================================================================
+// Semaphores
+//==================================================================================================
+
+void cothread_sem_init(cothread_sem_t *sem, uint16_t count){
+    sem->count = count;
+    WaitqInit(&sem->waiters);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_sem_wait(cothread_sem_t *sem){
+    cothread_task_t *self = cothread_self();
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(sem->count){
+            sem->count--;
+            return;
+        }
+        WaitqPush(&sem->waiters, self);
+    }
+    
+    // cothread_sem_post() hands its count directly to this thread
+    WaitReleased(self);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool cothread_sem_trywait(cothread_sem_t *sem){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(sem->count){
+            sem->count--;
+            return(true);
+        }
+    }
+    return(false);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_sem_post(cothread_sem_t *sem){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(WaitqRelease(&sem->waiters) == NULL){
+            sem->count++;
+        }
+    }
+}
+
+//==================================================================================================
+// Mutexes
+//==================================================================================================
+
+void cothread_mutex_init(cothread_mutex_t *mutex){
+    mutex->owner = NULL;
+    WaitqInit(&mutex->waiters);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_mutex_lock(cothread_mutex_t *mutex){
+    cothread_task_t *self = cothread_self();
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(mutex->owner == NULL){
+            mutex->owner = self;
+            return;
+        }
+        WaitqPush(&mutex->waiters, self);
+    }
+    
+    // cothread_mutex_unlock() hands ownership directly to this thread
+    WaitReleased(self);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool cothread_mutex_trylock(cothread_mutex_t *mutex){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(mutex->owner == NULL){
+            mutex->owner = cothread_self();
+            return(true);
+        }
+    }
+    return(false);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_mutex_unlock(cothread_mutex_t *mutex){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        mutex->owner = WaitqRelease(&mutex->waiters);
+    }
+}
+
+//==================================================================================================
+// Condition Variables
+//==================================================================================================
+
+void cothread_cond_init(cothread_cond_t *cond){
+    WaitqInit(&cond->waiters);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_cond_wait(cothread_cond_t *cond, cothread_mutex_t *mutex){
+    cothread_task_t *self = cothread_self();
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        WaitqPush(&cond->waiters, self);
+    }
+    cothread_mutex_unlock(mutex);
+    
+    WaitReleased(self);
+    
+    cothread_mutex_lock(mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_cond_signal(cothread_cond_t *cond){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        WaitqRelease(&cond->waiters);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_cond_broadcast(cothread_cond_t *cond){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        while(WaitqRelease(&cond->waiters));
+    }
+}
+
+//==================================================================================================
+// Channels
+//==================================================================================================
+
+void cothread_chan_init(cothread_chan_t *chan, void *buf, size_t bufsize, size_t msg_size){
+    fifo_init(&chan->fifo, buf, bufsize);
+    chan->msg_size = msg_size;
+    WaitqInit(&chan->receivers);
+    WaitqInit(&chan->senders);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t cothread_chan_trysend(cothread_chan_t *chan, void *msg){
+    RES_t res;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        res = fifo_write(&chan->fifo, msg, chan->msg_size);
+        if(res == RES_OK){
+            WaitqRelease(&chan->receivers);
+        }
+    }
+    
+    if(res != RES_OK){
+        return(RES_FULL);
+    }
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_chan_send(cothread_chan_t *chan, void *msg){
+    cothread_task_t *self = cothread_self();
+    
+    while(1){
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(fifo_write(&chan->fifo, msg, chan->msg_size) == RES_OK){
+                WaitqRelease(&chan->receivers);
+                return;
+            }
+            WaitqPush(&chan->senders, self);
+        }
+        
+        // Released once a message was received. Another sender could take the space first, so
+        // try again.
+        WaitReleased(self);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t cothread_chan_tryrecv(cothread_chan_t *chan, void *msg){
+    RES_t res;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        res = fifo_read(&chan->fifo, msg, chan->msg_size);
+        if(res == RES_OK){
+            WaitqRelease(&chan->senders);
+        }
+    }
+    
+    if(res != RES_OK){
+        return(RES_UNDERRUN);
+    }
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_chan_recv(cothread_chan_t *chan, void *msg){
+    cothread_task_t *self = cothread_self();
+    
+    while(1){
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(fifo_read(&chan->fifo, msg, chan->msg_size) == RES_OK){
+                WaitqRelease(&chan->senders);
+                return;
+            }
+            WaitqPush(&chan->receivers, self);
+        }
+        
+        // Released once a message was sent. Another receiver could take it first, so try again.
+        WaitReleased(self);
+    }
+}
+
+///\}
@@ -0,0 +1,282 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_COTHREAD_SYNC Thread Synchronization
+* \brief Semaphores, mutexes, condition variables and channels for scheduled cothreads
+* \author Alex Mykyta 
+*
+* Lets \ref MOD_COTHREAD_SCHED threads wait for each other or for ISRs without polling. A thread
+* that has to wait is parked in the object's wait queue and blocked with cothread_block(). It is
+* only made ready again once it is signaled. Waiters are released in the order they started
+* waiting.
+*
+* The waiting functions must only be called from scheduled threads. Functions that are marked as
+* ISR-safe can also be called from ISRs, which must then end with COTHREAD_WAKE_ON_EXIT().
+*
+* \code
+*     uint8_t rx_buf[16];
+*     cothread_chan_t rx_chan;
+*     
+*     ISR(USCI_A0, uart_rx_isr){
+*         uint8_t c = UCA0RXBUF;
+*         cothread_chan_trysend(&rx_chan, &c);
+*         COTHREAD_WAKE_ON_EXIT();
+*     }
+*     
+*     int rx_thread(void){
+*         uint8_t c;
+*         while(1){
+*             cothread_chan_recv(&rx_chan, &c); // Blocks until the ISR sends a byte
+*             // ...
+*         }
+*         return(0);
+*     }
+*     
+*     // During init:
+*     cothread_chan_init(&rx_chan, rx_buf, sizeof(rx_buf), 1);
+* \endcode
+*
+* \ref MOD_COTHREAD_SYNC also requires the following modules:
+*    - \ref MOD_COTHREAD_SCHED
+*    - \ref MOD_FIFO
+*
+* \{
+**/
+
+/**
+* \file
+* \brief Include file for \ref MOD_COTHREAD_SYNC
+* \author Alex Mykyta 
+**/
+
+#ifndef COTHREAD_SYNC_H
+#define COTHREAD_SYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <result.h>
+
+#include <fifo.h>
+#include "cothread_sched.h"
+
+//==================================================================================================
+// Types
+//==================================================================================================
+
+/// Queue of waiting threads. All members are private.
+typedef struct{
+    cothread_task_t *head;
+    cothread_task_t *tail;
+} cothread_waitq_t;
+
+/// Counting semaphore
+typedef struct{
+    uint16_t count;
+    cothread_waitq_t waiters;
+} cothread_sem_t;
+
+/// Mutex. Not recursive.
+typedef struct{
+    cothread_task_t *owner;
+    cothread_waitq_t waiters;
+} cothread_mutex_t;
+
+/// Condition variable
+typedef struct{
+    cothread_waitq_t waiters;
+} cothread_cond_t;
+
+/// Bounded channel of fixed-size messages
+typedef struct{
+    FIFO_t fifo;
+    size_t msg_size;
+    cothread_waitq_t receivers;
+    cothread_waitq_t senders;
+} cothread_chan_t;
+
+//==================================================================================================
+// Function Prototypes
+//==================================================================================================
+
+///\name Semaphores
+///\{
+
+/**
+* \brief Initializes a semaphore
+* \param [in] sem Semaphore
+* \param [in] count Initial count
+**/
+void cothread_sem_init(cothread_sem_t *sem, uint16_t count);
+
+/**
+* \brief Decrements the semaphore, waiting until its count is above 0
+* \param [in] sem Semaphore
+**/
+void cothread_sem_wait(cothread_sem_t *sem);
+
+/**
+* \brief Decrements the semaphore if its count is above 0
+* \param [in] sem Semaphore
+* \retval true    Semaphore was decremented
+* \retval false    Count was 0
+* \details ISR-safe
+**/
+bool cothread_sem_trywait(cothread_sem_t *sem);
+
+/**
+* \brief Increments the semaphore, or hands the count to the first waiting thread
+* \param [in] sem Semaphore
+* \details ISR-safe. The calling thread keeps running.
+**/
+void cothread_sem_post(cothread_sem_t *sem);
+
+///\}
+
+///\name Mutexes
+///\{
+
+/**
+* \brief Initializes a mutex in the unlocked state
+* \param [in] mutex Mutex
+**/
+void cothread_mutex_init(cothread_mutex_t *mutex);
+
+/**
+* \brief Locks a mutex, waiting until it is free
+* \param [in] mutex Mutex
+**/
+void cothread_mutex_lock(cothread_mutex_t *mutex);
+
+/**
+* \brief Locks a mutex if it is free
+* \param [in] mutex Mutex
+* \retval true    Mutex was locked
+* \retval false    Mutex is owned by another thread
+**/
+bool cothread_mutex_trylock(cothread_mutex_t *mutex);
+
+/**
+* \brief Unlocks a mutex
+* \param [in] mutex Mutex. Must be owned by the calling thread.
+* \details Ownership is handed to the first waiting thread, if any.
+**/
+void cothread_mutex_unlock(cothread_mutex_t *mutex);
+
+///\}
+
+///\name Condition Variables
+///\{
+
+/**
+* \brief Initializes a condition variable
+* \param [in] cond Condition variable
+**/
+void cothread_cond_init(cothread_cond_t *cond);
+
+/**
+* \brief Unlocks the mutex, waits until the condition is signaled, then locks the mutex again
+* \param [in] cond Condition variable
+* \param [in] mutex Mutex. Must be owned by the calling thread.
+* \details The thread starts waiting before the mutex is unlocked, so a signal that comes right after
+*   can not be missed. As usual, the caller should check its condition again in a loop.
+**/
+void cothread_cond_wait(cothread_cond_t *cond, cothread_mutex_t *mutex);
+
+/**
+* \brief Wakes the first thread waiting on a condition
+* \param [in] cond Condition variable
+* \details ISR-safe
+**/
+void cothread_cond_signal(cothread_cond_t *cond);
+
+/**
+* \brief Wakes all threads waiting on a condition
+* \param [in] cond Condition variable
+* \details ISR-safe
+**/
+void cothread_cond_broadcast(cothread_cond_t *cond);
+
+///\}
+
+///\name Channels
+///\{
+
+/**
+* \brief Initializes a channel
+* \param [in] chan Channel
+* \param [in] buf Buffer for the messages. See fifo_init() for how much of it is usable.
+* \param [in] bufsize Size of \c buf in bytes
+* \param [in] msg_size Size of each message in bytes
+**/
+void cothread_chan_init(cothread_chan_t *chan, void *buf, size_t bufsize, size_t msg_size);
+
+/**
+* \brief Sends a message, waiting while the channel is full
+* \param [in] chan Channel
+* \param [in] msg Message of \c msg_size bytes
+**/
+void cothread_chan_send(cothread_chan_t *chan, void *msg);
+
+/**
+* \brief Sends a message if there is room
+* \param [in] chan Channel
+* \param [in] msg Message of \c msg_size bytes
+* \retval RES_OK    Message sent
+* \retval RES_FULL    Channel is full
+* \details ISR-safe
+**/
+RES_t cothread_chan_trysend(cothread_chan_t *chan, void *msg);
+
+/**
+* \brief Receives a message, waiting while the channel is empty
+* \param [in] chan Channel
+* \param [out] msg Buffer of \c msg_size bytes for the message
+**/
+void cothread_chan_recv(cothread_chan_t *chan, void *msg);
+
+/**
+* \brief Receives a message if one is available
+* \param [in] chan Channel
+* \param [out] msg Buffer of \c msg_size bytes for the message
+* \retval RES_OK    Message received
+* \retval RES_UNDERRUN    Channel is empty
+* \details ISR-safe
+**/
+RES_t cothread_chan_tryrecv(cothread_chan_t *chan, void *msg);
+
+///\}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+///\}
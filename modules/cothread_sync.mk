@@ -0,0 +1,4 @@
+
+########################################### Module Setup ###########################################
+MODULE_SOURCES += cothread_sync.c
+REQUIRED_MODULES += cothread_sched fifo
@@ -159,13 +159,18 @@
     \moduletable{Services}
     \moduleentry{MOD_CLI,Generic Command Line Interface.}
     \moduleentry{MOD_COTHREADS,Cooperative Processor Threads.}
+    \moduleentry{MOD_COTHREAD_POOL,Pooled thread stacks with overflow guards.}
+    \moduleentry{MOD_COTHREAD_SCHED,Round-robin scheduler for cooperative threads.}
+    \moduleentry{MOD_COTHREAD_SYNC,Blocking synchronization and channels for cooperative threads.}
     \moduleentry{MOD_EVENT_QUEUE,A simple first-in first-out event handler.}
+    \moduleentry{MOD_EVENT_TIMER,Delayed and periodic events.}
     \moduleentry{MOD_FLASHFS,Light-weight file system for Flash volumes.}
     \moduleentry{MOD_TIMER,Timer Driver.}
     \endmoduletable
 
     \moduletable{Utilities}
     \moduleentry{MOD_FIFO,A generic First-in First-out buffer.}
+    \moduleentry{MOD_FIFO_DMA,Moves bulk data into and out of a FIFO using DMA.}
     \moduleentry{MOD_SLEEP,Sleep functions to kill time.}
     \moduleentry{MOD_STRING_EXT,Additional string functions.}
     \endmoduletable
@@ -0,0 +1,24 @@
+
+// Event queue configuration used by event_queue_bench.c
+// EVENT_QUEUE_SIZE is normally set on the command line by the Makefile.
+
+#ifndef EVENT_QUEUE_CONFIG_H
+#define EVENT_QUEUE_CONFIG_H
+
+#ifndef EVENT_QUEUE_SIZE
+	#define EVENT_QUEUE_SIZE	256
+#endif
+
+#define EVENT_QUEUE_PRIO_LEVELS	1
+#define EVENT_PRIO_DEFAULT	0
+#define EVENT_QUEUE_POW2	0
+#define EVENT_QUEUE_RESERVE	0
+#define EVENT_OVF_SOURCES	0
+#define EVENT_UNIQUE_SLOTS	8
+#define MAX_YIELD_DEPTH	2
+#define EVENT_COTHREADS	0
+#define EVENT_IDLE_SLEEP	0
+#define EVENT_QUEUE_STATS	0
+#define EVENT_QUEUE_TRACE	0
+
+#endif
@@ -42,10 +42,9 @@
 **/
 
 #include <stdint.h>
-#include <setjmp.h>
-#include <pthread.h>
 #include <stdio.h>
-#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
 #include "cothread.h"
 
 
@@ -89,16 +88,232 @@
  
 static cothread_t *CurrentThread;
 static int ThreadRetval;
+static void (*OverflowHandler)(cothread_t *thread);
+
+//--------------------------------------------------------------------------------------------------
+// Called before CurrentThread switches out. Checks that it did not overflow its stack.
+static void check_guard(void){
+	if(CurrentThread->guard && (*CurrentThread->guard != COTHREAD_GUARD_WORD)){
+		if(OverflowHandler){
+			OverflowHandler(CurrentThread);
+		}
+		fprintf(stderr, "cothread: stack overflow detected\n");
+		abort();
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_set_overflow_handler(void (*handler)(cothread_t *thread)){
+	OverflowHandler = handler;
+}
+
+#if(COTHREAD_EMU_USE_PTHREAD == 0)
+//==================================================================================================
+// Native stack switching
+//==================================================================================================
+
+// Saves the callee-saved registers on the current stack, stores the stack pointer in *save_sp,
+// then loads load_sp and restores the registers that were saved there.
+void ct_emu_swap(void **save_sp, void *load_sp);
+
+#if defined(__x86_64__)
+__asm__(
+	".text\n"
+	".globl ct_emu_swap\n"
+	".type ct_emu_swap, @function\n"
+	"ct_emu_swap:\n"
+	"	pushq %rbp\n"
+	"	pushq %rbx\n"
+	"	pushq %r12\n"
+	"	pushq %r13\n"
+	"	pushq %r14\n"
+	"	pushq %r15\n"
+	"	movq %rsp, (%rdi)\n"
+	"	movq %rsi, %rsp\n"
+	"	popq %r15\n"
+	"	popq %r14\n"
+	"	popq %r13\n"
+	"	popq %r12\n"
+	"	popq %rbx\n"
+	"	popq %rbp\n"
+	"	ret\n"
+	".size ct_emu_swap, .-ct_emu_swap\n"
+);
+
+// Registers popped by ct_emu_swap() before it returns into the new thread
+#define SWAP_FRAME_WORDS	6
+
+#elif defined(__aarch64__)
+__asm__(
+	".text\n"
+	".globl ct_emu_swap\n"
+	".type ct_emu_swap, %function\n"
+	"ct_emu_swap:\n"
+	"	sub sp, sp, #160\n"
+	"	stp x19, x20, [sp, #0]\n"
+	"	stp x21, x22, [sp, #16]\n"
+	"	stp x23, x24, [sp, #32]\n"
+	"	stp x25, x26, [sp, #48]\n"
+	"	stp x27, x28, [sp, #64]\n"
+	"	stp x29, x30, [sp, #80]\n"
+	"	stp d8, d9, [sp, #96]\n"
+	"	stp d10, d11, [sp, #112]\n"
+	"	stp d12, d13, [sp, #128]\n"
+	"	stp d14, d15, [sp, #144]\n"
+	"	mov x2, sp\n"
+	"	str x2, [x0]\n"
+	"	mov sp, x1\n"
+	"	ldp x19, x20, [sp, #0]\n"
+	"	ldp x21, x22, [sp, #16]\n"
+	"	ldp x23, x24, [sp, #32]\n"
+	"	ldp x25, x26, [sp, #48]\n"
+	"	ldp x27, x28, [sp, #64]\n"
+	"	ldp x29, x30, [sp, #80]\n"
+	"	ldp d8, d9, [sp, #96]\n"
+	"	ldp d10, d11, [sp, #112]\n"
+	"	ldp d12, d13, [sp, #128]\n"
+	"	ldp d14, d15, [sp, #144]\n"
+	"	add sp, sp, #160\n"
+	"	ret\n"
+	".size ct_emu_swap, .-ct_emu_swap\n"
+);
+
+#define SWAP_FRAME_WORDS	20
+#define SWAP_FRAME_LR		11	// Index of the saved x30 in the frame
+
+#else
+	#error "Native cothread switching is not available on this host. Set COTHREAD_EMU_USE_PTHREAD to 1"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+static void cothread_startup(void){
+	int ret;
+	
+	// kick-off the new thread
+	ret = CurrentThread->m_state.func();
+	
+	// Thread returned. try to exit the thread.
+	cothread_exit(ret);
+	
+	// Nowhere to go
+	fprintf(stderr, "cothread: thread returned without a valid co_exit\n");
+	abort();
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_init(cothread_t *home_thread){
+	home_thread->co_exit = NULL;
+	home_thread->alt_stack = NULL;
+	home_thread->alt_stack_size = 1;
+	home_thread->guard = NULL;
+	home_thread->m_state.valid = 1;
+	
+	CurrentThread = home_thread;
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_create(cothread_t *thread, int (*func) (void)){
+	uintptr_t *frame;
+	uintptr_t top;
+	
+	thread->m_state.func = func;
+	thread->guard = NULL;
+	
+	// Build a frame at the top of the stack that ct_emu_swap() "returns" into cothread_startup()
+	// with the stack aligned the way a normal call would leave it.
+	top = ((uintptr_t)thread->alt_stack + thread->alt_stack_size) & ~(uintptr_t)15;
+	
+	#if defined(__x86_64__)
+		frame = (uintptr_t*)top;
+		*--frame = 0;	// Return address of cothread_startup(). Never used.
+		*--frame = (uintptr_t)cothread_startup;
+		frame -= SWAP_FRAME_WORDS;
+		memset(frame, 0, SWAP_FRAME_WORDS*sizeof(uintptr_t));
+	#elif defined(__aarch64__)
+		frame = (uintptr_t*)top - SWAP_FRAME_WORDS;
+		memset(frame, 0, SWAP_FRAME_WORDS*sizeof(uintptr_t));
+		frame[SWAP_FRAME_LR] = (uintptr_t)cothread_startup;
+	#endif
+	
+	thread->m_state.sp = frame;
+	
+	// This thread is now officially valid
+	thread->m_state.valid = 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+int cothread_switch(cothread_t *dest_thread){
+	cothread_t *old_current;
+	
+	if(dest_thread == CurrentThread) return(-1); // already in the dest_thread. nothing to do
+	if(!(dest_thread->m_state.valid)) return(-1); // dest_thread is not valid. Don't switch
+	
+	check_guard();
+	
+	old_current = CurrentThread;
+	CurrentThread = dest_thread;
+	ThreadRetval = 0;
+	
+	ct_emu_swap(&old_current->m_state.sp, dest_thread->m_state.sp);
+	// Other thread will switch back here later
+	
+	return(ThreadRetval);
+}
+
+//--------------------------------------------------------------------------------------------------
+void cothread_exit(int retval){
+	void *dead_sp;
+	
+	// exit only if it has a valid exit destination
+	if(CurrentThread->co_exit){
+		check_guard();
+		
+		// the thread is no longer valid
+		CurrentThread->m_state.valid = 0;
+		
+		CurrentThread = CurrentThread->co_exit;
+		ThreadRetval = retval;
+		
+		ct_emu_swap(&dead_sp, CurrentThread->m_state.sp);
+	}
+}
+
+#else
+//==================================================================================================
+// pthread backed threads
+//==================================================================================================
+
+// Lets thread run and wakes it up
+static void thread_release(cothread_t *thread){
+	pthread_mutex_lock(&thread->m_state.thread_mutex);
+	thread->m_state.run = 1;
+	pthread_cond_signal(&thread->m_state.thread_condition);
+	pthread_mutex_unlock(&thread->m_state.thread_mutex);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Waits until the calling thread is switched to. The run flag makes sure that a switch that
+// happens before the thread starts waiting is not lost.
+static void thread_hold(cothread_t *thread){
+	pthread_mutex_lock(&thread->m_state.thread_mutex);
+	while(!thread->m_state.run){
+		pthread_cond_wait(&thread->m_state.thread_condition, &thread->m_state.thread_mutex);
+	}
+	thread->m_state.run = 0;
+	pthread_mutex_unlock(&thread->m_state.thread_mutex);
+}
 
 //--------------------------------------------------------------------------------------------------
 void cothread_init(cothread_t *home_thread){
 	home_thread->co_exit = NULL;
 	home_thread->alt_stack = NULL;
 	home_thread->alt_stack_size = 1;
+	home_thread->guard = NULL;
 	home_thread->m_state.valid = 1;
+	home_thread->m_state.run = 0;
 	
-	home_thread->m_state.thread_mutex = PTHREAD_MUTEX_INITIALIZER;
-	home_thread->m_state.thread_condition = PTHREAD_COND_INITIALIZER;
+	pthread_mutex_init(&home_thread->m_state.thread_mutex, NULL);
+	pthread_cond_init(&home_thread->m_state.thread_condition, NULL);
 	
 	CurrentThread = home_thread;
 }
@@ -112,16 +327,13 @@ static void *cothread_startup(void *arg){
 	cothread_t *thread = (cothread_t *) arg;
 	
 	// Thread has been created but it isn't allowed to start yet. Freeze it.
-	pthread_mutex_lock(&thread->m_state.thread_mutex);
-	pthread_cond_wait(&thread->m_state.thread_condition, &thread->m_state.thread_mutex);
-	pthread_mutex_unlock(&thread->m_state.thread_mutex);
+	thread_hold(thread);
 	
 	// kick-off the new thread
 	ThreadRetval = thread->m_state.func();
 	
 	// the thread is no longer valid
 	CurrentThread->m_state.valid = 0;
-
 	
 	// if co_exit is valid, switch to it
 	if(CurrentThread->co_exit){
@@ -129,9 +341,7 @@ static void *cothread_startup(void *arg){
 		CurrentThread = CurrentThread->co_exit;
 		
 		// signal the dest thread to continue
-		pthread_mutex_lock(&old_current->co_exit->m_state.thread_mutex);
-		pthread_cond_signal(&old_current->co_exit->m_state.thread_condition); 
-		pthread_mutex_unlock(&old_current->co_exit->m_state.thread_mutex);
+		thread_release(old_current->co_exit);
 		
 		// kill this thread
 		return(NULL);
@@ -146,16 +356,16 @@ static void *cothread_startup(void *arg){
 void cothread_create(cothread_t *thread, int (*func) (void)){
 	
 	thread->m_state.func = func;
+	thread->guard = NULL;
 	
 	thread->m_state.valid = 1;
+	thread->m_state.run = 0;
 	
-	thread->m_state.thread_mutex = PTHREAD_MUTEX_INITIALIZER;
-	thread->m_state.thread_condition = PTHREAD_COND_INITIALIZER;
-
+	pthread_mutex_init(&thread->m_state.thread_mutex, NULL);
+	pthread_cond_init(&thread->m_state.thread_condition, NULL);
 	
 	pthread_create( &thread->m_state.thread, NULL, (void *) &cothread_startup, (void *) thread);
-	
-	usleep(1000); // Need to give the new thread time to startup
+	pthread_detach(thread->m_state.thread);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -165,6 +375,8 @@ int cothread_switch(cothread_t *dest_thread){
 	if(dest_thread == CurrentThread) return(-1); // already in the dest_thread. nothing to do
 	if(!(dest_thread->m_state.valid)) return(-1); // dest_thread is not valid. Don't switch
 	
+	check_guard();
+	
 	old_current = CurrentThread;
 	
 	CurrentThread = dest_thread;
@@ -172,15 +384,10 @@ int cothread_switch(cothread_t *dest_thread){
 	ThreadRetval = 0;
 	
 	// signal the dest thread to continue
-	pthread_mutex_lock(&dest_thread->m_state.thread_mutex);
-	pthread_cond_signal(&dest_thread->m_state.thread_condition); 
-	pthread_mutex_unlock(&dest_thread->m_state.thread_mutex);
-	
+	thread_release(dest_thread);
 	
 	// put the current thread into a wait state
-	pthread_mutex_lock(&old_current->m_state.thread_mutex);
-	pthread_cond_wait( &old_current->m_state.thread_condition, &old_current->m_state.thread_mutex);
-	pthread_mutex_unlock(&old_current->m_state.thread_mutex);
+	thread_hold(old_current);
 	
 	return(ThreadRetval);
 }
@@ -191,6 +398,8 @@ void cothread_exit(int retval){
 	
 	// exit only if it has a valid exit destination
 	if(CurrentThread->co_exit){
+		check_guard();
+		
 		// the thread is no longer valid
 		CurrentThread->m_state.valid = 0;
 		
@@ -201,14 +410,19 @@ void cothread_exit(int retval){
 		ThreadRetval = retval;
 		
 		// signal the dest thread to continue
-		pthread_mutex_lock(&old_current->co_exit->m_state.thread_mutex);
-		pthread_cond_signal(&old_current->co_exit->m_state.thread_condition); 
-		pthread_mutex_unlock(&old_current->co_exit->m_state.thread_mutex);
+		thread_release(old_current->co_exit);
 		
 		// kill this thread
 		pthread_exit(NULL);
 	}
 }
+#endif
+
+//--------------------------------------------------------------------------------------------------
+int cothread_yield_to(cothread_t *dest_thread){
+	// The native switch already only saves the callee-saved registers
+	return(cothread_switch(dest_thread));
+}
 
 //--------------------------------------------------------------------------------------------------
 size_t dummy_stack_size = 0xFFFFFFFFL;
@@ -223,5 +437,88 @@ size_t stackmon_get_unused(stack_t *stack){
 	return(dummy_stack_size);
 }
 
+//--------------------------------------------------------------------------------------------------
+// Stacks registered for stackmon_sample_all()
+static stackmon_t *StackmonList;
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_fill(stack_t *stack, size_t stack_size){
+	size_t i;
+	
+	stack_size = stack_size/sizeof(stack_t);
+	for(i=0;i<stack_size;i++){
+		stack[i] = STACKMON_FILL_WORD;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t stackmon_get_unused_fast(stack_t *stack, size_t stack_size){
+	size_t lo, hi, mid;
+	
+	// Find the first word from the base that was overwritten
+	lo = 0;
+	hi = stack_size/sizeof(stack_t);
+	while(lo < hi){
+		mid = lo + (hi - lo)/2;
+		if(stack[mid] == STACKMON_FILL_WORD){
+			lo = mid + 1;
+		}else{
+			hi = mid;
+		}
+	}
+	
+	return(lo*sizeof(stack_t));
+}
+
+//--------------------------------------------------------------------------------------------------
+static void stackmon_add(stackmon_t *mon, const char *name, stack_t *stack, size_t stack_size){
+	stackmon_t *m;
+	
+	mon->name = name;
+	mon->stack = stack;
+	mon->size = stack_size;
+	mon->min_unused = stack_size;
+	
+	// A monitor that is registered again (for a reused stack) is already in the list
+	for(m = StackmonList; m; m = m->next){
+		if(m == mon) return;
+	}
+	mon->next = StackmonList;
+	StackmonList = mon;
+}
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_register(stackmon_t *mon, const char *name, stack_t *stack, size_t stack_size){
+	stackmon_fill(stack, stack_size);
+	stackmon_add(mon, name, stack, stack_size);
+}
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_register_main(stackmon_t *mon, const char *name){
+	// The host's main stack can't be filled safely
+	stackmon_add(mon, name, NULL, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+void stackmon_sample_all(void){
+	stackmon_t *mon;
+	size_t unused;
+	
+	for(mon = StackmonList; mon; mon = mon->next){
+		if(mon->size == 0){
+			continue;
+		}
+		unused = stackmon_get_unused_fast(mon->stack, mon->size);
+		if(unused < mon->min_unused){
+			mon->min_unused = unused;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+stackmon_t* stackmon_list(void){
+	return(StackmonList);
+}
+
 ///\}
 ///\}
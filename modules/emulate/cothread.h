@@ -126,26 +126,71 @@
 
 #include <stdint.h>
 #include <stddef.h>
-#include <pthread.h>
+
+#ifndef COTHREAD_EMU_USE_PTHREAD
+	#if defined(__x86_64__) || defined(__aarch64__)
+		#define COTHREAD_EMU_USE_PTHREAD	0
+	#else
+		#define COTHREAD_EMU_USE_PTHREAD	1
+	#endif
+#endif
+/**<
+ * 0 = Threads run on their \c alt_stack and cothread_switch() swaps the stack pointer and the
+ *     callee-saved registers directly. Only available on x86-64 and AArch64.\n
+ * 1 = Each thread is backed by a pthread and control is handed over with a condition variable.
+ *     Much slower, but portable. \c alt_stack is not used.
+ * 
+ * \note Host code needs a lot more stack than the MSP430. Threads that call the C library
+ * (printf() etc.) need several KB of \c alt_stack when \c COTHREAD_EMU_USE_PTHREAD is 0.
+**/
+
+#if(COTHREAD_EMU_USE_PTHREAD == 1)
+	#include <pthread.h>
+#endif
 
 typedef uintptr_t stack_t;
 
+/// Value of the stack guard words planted by \ref MOD_COTHREAD_POOL
+#define COTHREAD_GUARD_WORD ((stack_t)0xA55AC33CUL)
+
+/// Value that stackmon_fill() fills unused stack space with
+#define STACKMON_FILL_WORD ((stack_t)0xCDCDCDCDUL)
+
+#if(COTHREAD_EMU_USE_PTHREAD == 1)
 typedef struct{
     pthread_mutex_t thread_mutex;
 	pthread_cond_t thread_condition;
 	pthread_t thread;
 	int (*func) (void);
+	uint8_t run;	// Set when the thread has been switched to. Guarded by thread_mutex.
+	uint8_t valid;
+} m_state_t;
+#else
+typedef struct{
+	void *sp;	// Saved stack pointer while the thread is switched out
+	int (*func) (void);
 	uint8_t valid;
 } m_state_t;
+#endif
 
 
 typedef struct cothread{
 	struct cothread	*co_exit; ///< Thread to switch to once the current thread exits
 	stack_t *alt_stack; ///< Pointer to the base of an alternate stack.
 	size_t alt_stack_size; ///< The size (in bytes) of the stack which 'alt_stack' points to.
+	stack_t *guard; ///< Guard word that is checked whenever the thread switches out. NULL if unused. Set by \ref MOD_COTHREAD_POOL.
 	m_state_t m_state; ///< This element stores the machine state of the process. Its definition should be treated as opaque
 } cothread_t;
 
+/// Registered stack for stackmon_sample_all(). All members are read-only.
+typedef struct stackmon{
+	const char *name;	   ///< Name of the stack
+	stack_t *stack;		 ///< Base (lowest address) of the stack
+	size_t size;			///< Size of the stack in bytes
+	size_t min_unused;	  ///< Fewest unused bytes seen by stackmon_sample_all()
+	struct stackmon *next;
+} stackmon_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * \brief Initializes the home thread object
@@ -191,6 +236,14 @@ void cothread_create(cothread_t *thread, int (*func) (void));
  **/
 int cothread_switch(cothread_t *dest_thread);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Switch to a different context using the fast path
+ * 
+ * On host builds this is the same as cothread_switch().
+ **/
+int cothread_yield_to(cothread_t *dest_thread);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * \brief Terminates the current thread
@@ -199,6 +252,18 @@ int cothread_switch(cothread_t *dest_thread);
 **/
 void cothread_exit(int retval);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Sets the function that is called when a stack overflow is detected
+ * 
+ * If a thread has a stack guard word (see \ref MOD_COTHREAD_POOL), it is checked every time the
+ * thread switches out or exits. If it was overwritten, \c handler is called from the overflowed
+ * thread instead of switching. If no handler is set, or it returns, the program aborts.
+ * 
+ * \param handler Overflow handler. Receives the thread that overflowed.
+ **/
+void cothread_set_overflow_handler(void (*handler)(cothread_t *thread));
+
 //--------------------------------------------------------------------------------------------------
 /**
  * \name Stack Monitor Functions
@@ -227,6 +292,67 @@ void stackmon_init(stack_t *stack, size_t stack_size);
  **/
 size_t stackmon_get_unused(stack_t *stack);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Fill a stack with #STACKMON_FILL_WORD
+ * \details Use with stackmon_get_unused_fast(). This must be done \e prior to calling
+ * cothread_create()
+ * \param stack        Pointer to the allocated stack
+ * \param stack_size    The size of the stack in bytes
+ **/
+void stackmon_fill(stack_t *stack, size_t stack_size);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Determine how much of a stack filled by stackmon_fill() was untouched
+ * \details Binary searches for the highest point the stack has reached, so it only reads about
+ * log2(stack_size) words. It assumes that everything the stack has reached was overwritten. A word
+ * that happens to hold #STACKMON_FILL_WORD in a deep frame (an uninitialized local array for
+ * example) can make the result larger than it really is.
+ * \param stack        Pointer to the allocated stack
+ * \param stack_size    The size of the stack in bytes
+ * \return Number of bytes remaining in the stack.
+ **/
+size_t stackmon_get_unused_fast(stack_t *stack, size_t stack_size);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Fill an alternate stack and add it to the list sampled by stackmon_sample_all()
+ * \note This must be done \e prior to calling cothread_create()
+ * \details Registering the same \c mon again, for a stack that is being reused, only resets it.
+ * \param mon          Monitor object. Must stay valid.
+ * \param name         Name of the stack
+ * \param stack        Pointer to the allocated stack
+ * \param stack_size    The size of the stack in bytes
+ **/
+void stackmon_register(stackmon_t *mon, const char *name, stack_t *stack, size_t stack_size);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Fill the free part of the main C stack and add it to the list sampled by stackmon_sample_all()
+ * \details The main stack spans from the end of the \c .bss and \c .noinit sections up to the
+ * initial stack pointer. The part below the current stack pointer is filled, so call this as early
+ * as possible in main(). It can't be used if the application uses the heap.
+ * 
+ * On host builds the main stack can't be measured. It is listed with a size of 0.
+ * \param mon          Monitor object. Must stay valid.
+ * \param name         Name of the stack
+ **/
+void stackmon_register_main(stackmon_t *mon, const char *name);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Update the \c min_unused of all registered stacks
+ * \details Cheap enough to call periodically, for example from a timer event.
+ **/
+void stackmon_sample_all(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * \brief Returns the first registered stack. Follow \c next for the others.
+ **/
+stackmon_t* stackmon_list(void);
+
 ///\}
 //--------------------------------------------------------------------------------------------------
 
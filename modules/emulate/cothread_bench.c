@@ -0,0 +1,69 @@
+
+// Context switch benchmark for the emulated cothreads.
+// The home thread and one alternate thread switch back and forth. Prints one CSV row:
+//   backend,switches,switches_per_sec
+//
+// Build and compare both backends with:
+//   make bench-cothread
+//
+// Usage:
+//   ./cothread_bench [-H] [switches]
+//   -H only prints the CSV header
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "cothread.h"
+
+stack_t alt_stack[16384/sizeof(stack_t)];
+cothread_t ct_home;
+cothread_t ct_alt;
+
+unsigned long n_switches = 1000000;
+
+//--------------------------------------------------------------------------------------------------
+static uint64_t now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec);
+}
+
+//--------------------------------------------------------------------------------------------------
+int alt_func(void){
+	while(1){
+		cothread_switch(&ct_home);
+	}
+	return(0);
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[]){
+	uint64_t start, elapsed;
+	unsigned long i;
+	
+	if(argc > 1 && strcmp(argv[1], "-H") == 0){
+		printf("backend,switches,switches_per_sec\n");
+		return(0);
+	}
+	if(argc > 1) n_switches = strtoul(argv[1], NULL, 0);
+	
+	cothread_init(&ct_home);
+	ct_alt.alt_stack = alt_stack;
+	ct_alt.alt_stack_size = sizeof(alt_stack);
+	ct_alt.co_exit = &ct_home;
+	cothread_create(&ct_alt, alt_func);
+	
+	// Each iteration is two switches: home to alt and back
+	start = now_ns();
+	for(i=0; i<n_switches/2; i++){
+		cothread_switch(&ct_alt);
+	}
+	elapsed = now_ns() - start;
+	
+	printf("%s,%lu,%.0f\n", COTHREAD_EMU_USE_PTHREAD ? "pthread" : "native",
+			(n_switches/2)*2, ((n_switches/2)*2) / (elapsed / 1e9));
+	return(0);
+}
@@ -4,7 +4,7 @@
 
 #include "cothread.h"
 
-uint8_t alt_stack[64];
+uint8_t alt_stack[16384]; // Host builds need far more stack than the MSP430
 cothread_t ct_home;
 cothread_t ct_alt1;
 cothread_t ct_alt2;
@@ -0,0 +1,119 @@
+
+// Test for the host idle wait of the event queue (EVENT_IDLE_SLEEP = 2).
+// The event handler runs in its own thread. Once the queue is empty it must call onIdle() once and
+// then block: onIdle() is not called again and the thread uses next to no CPU time while idle.
+// A push from another thread must wake it, run the event and start a new idle period.
+//
+// Build:
+//   gcc -std=gnu99 -O2 -Wall -pthread -I test_config -I target_shim -I. -idirafter ../../include -DEVENT_IDLE_SLEEP=2 event_idle_test.c ../event_queue.c fifo.c event_wait.c -o event_idle_test
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <pthread.h>
+
+#include <event_queue.h>
+#include "event_wait.h"
+
+// Time the handler is left idle, and the CPU time it may use meanwhile
+#define IDLE_US		200000
+#define IDLE_CPU_US	20000
+
+unsigned long errors;
+
+volatile int idle_calls;
+volatile int events;
+volatile int stop;
+pthread_t handler_thread;
+
+//--------------------------------------------------------------------------------------------------
+static void check(int ok, const char *what){
+	if(!ok){
+		printf("Failed: %s\n", what);
+		errors++;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+static jmp_buf stop_jmp;
+
+void onIdle(void){
+	__atomic_add_fetch(&idle_calls, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&stop, __ATOMIC_SEQ_CST)){
+		longjmp(stop_jmp, 1);
+	}
+}
+
+static void *handler_main(void *arg){
+	if(!setjmp(stop_jmp)){
+		event_StartHandler();
+	}
+	return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void event(void){
+	__atomic_add_fetch(&events, 1, __ATOMIC_SEQ_CST);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Waits up to a second for a counter to reach a value
+static int wait_for(volatile int *counter, int value){
+	int i;
+
+	for(i=0; (i<1000) && (__atomic_load_n(counter, __ATOMIC_SEQ_CST) < value); i++){
+		usleep(1000);
+	}
+	return(__atomic_load_n(counter, __ATOMIC_SEQ_CST) >= value);
+}
+
+//--------------------------------------------------------------------------------------------------
+// CPU time used by the event handler thread in microseconds
+static long handler_cpu_us(void){
+	clockid_t clock;
+	struct timespec ts;
+
+	pthread_getcpuclockid(handler_thread, &clock);
+	clock_gettime(clock, &ts);
+	return(ts.tv_sec * 1000000L + ts.tv_nsec / 1000);
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(void){
+	long cpu;
+
+	event_init();
+	pthread_create(&handler_thread, NULL, handler_main, NULL);
+
+	// Empty queue: one onIdle() call, then the handler blocks
+	check(wait_for(&idle_calls, 1), "onIdle() is called once the queue is empty");
+	cpu = handler_cpu_us();
+	usleep(IDLE_US);
+	check(idle_calls == 1, "onIdle() is not called again while idle");
+	check(handler_cpu_us() - cpu < IDLE_CPU_US, "handler blocks while idle");
+
+	// A push from this thread wakes the handler
+	check(event_PushEvent(event, NULL, 0) == RES_OK, "push");
+	check(wait_for(&events, 1), "push wakes the handler");
+	check(wait_for(&idle_calls, 2), "onIdle() is called again after the event");
+
+	cpu = handler_cpu_us();
+	usleep(IDLE_US);
+	check(idle_calls == 2, "onIdle() is not called again after the event");
+	check(handler_cpu_us() - cpu < IDLE_CPU_US, "handler blocks again after the event");
+
+	// event_emu_wake() without a push makes the handler call onIdle(), which stops it
+	__atomic_store_n(&stop, 1, __ATOMIC_SEQ_CST);
+	event_emu_wake();
+	pthread_join(handler_thread, NULL);
+	check(idle_calls == 3, "event_emu_wake() starts a new idle period");
+	check(events == 1, "event runs once");
+
+	printf("event_idle (EVENT_IDLE_SLEEP=%d): %lu errors\n", EVENT_IDLE_SLEEP, errors);
+	if(errors){
+		return(1);
+	}
+	return(0);
+}
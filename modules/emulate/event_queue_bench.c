@@ -0,0 +1,201 @@
+
+// Throughput and latency benchmark for the event queue.
+// Several producer threads push events with varying payload sizes while the main thread runs the
+// event handler loop. Each run prints one CSV row:
+//   queue_size,producers,events,events_per_sec,mean_latency_ns,p99_latency_ns,full_rate,errors
+// Latency is measured from the push that succeeded to the start of the event handler.
+// full_rate is the fraction of push attempts that returned RES_FULL.
+//
+// Build and run across several queue sizes with:
+//   make bench
+//
+// Usage:
+//   ./event_queue_bench_<queue size> [-H] [producers] [events per producer]
+//   -H only prints the CSV header
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <setjmp.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "event_queue.h"
+#include <event_queue_config.h>
+
+// Payloads carry this header followed by 0 to PAD_MAX bytes of padding
+typedef struct {
+	uint64_t timestamp;
+	uint32_t producer;
+	uint32_t seq;
+} payload_t;
+
+#define PAD_MAX	16
+#define PAD_SIZE(seq)	((seq) % (PAD_MAX+1))
+
+unsigned int n_producers = 2;
+unsigned long n_events = 200000;
+
+unsigned int producers_done;	// Accessed with __atomic builtins
+unsigned long total_fulls;
+unsigned long total_attempts;
+
+uint32_t *next_seq;
+uint64_t *latency;
+unsigned long received;
+unsigned long errors;
+
+jmp_buf handler_exit;
+
+//--------------------------------------------------------------------------------------------------
+static uint64_t now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec);
+}
+
+//--------------------------------------------------------------------------------------------------
+static int cmp_u64(const void *a, const void *b){
+	uint64_t x = *(const uint64_t*)a;
+	uint64_t y = *(const uint64_t*)b;
+	return((x > y) - (x < y));
+}
+
+//--------------------------------------------------------------------------------------------------
+static void onBenchEvent(void){
+	uint64_t t = now_ns();
+	uint8_t pad[PAD_MAX];
+	payload_t p;
+	size_t i;
+	
+	event_PopEventData(&p, sizeof(p));
+	event_PopEventData(pad, PAD_SIZE(p.seq));
+	
+	latency[received++] = t - p.timestamp;
+	
+	// Events from each producer must arrive whole and in order
+	if(p.producer >= n_producers || p.seq != next_seq[p.producer]){
+		errors++;
+		return;
+	}
+	next_seq[p.producer]++;
+	
+	for(i=0; i<PAD_SIZE(p.seq); i++){
+		if(pad[i] != (uint8_t)(p.seq + i)){
+			errors++;
+			return;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void onIdle(void){
+	if(__atomic_load_n(&producers_done, __ATOMIC_ACQUIRE) == n_producers && !event_Pending()){
+		longjmp(handler_exit, 1);
+	}
+	sched_yield();
+}
+
+//--------------------------------------------------------------------------------------------------
+void *producer(void *arg){
+	uint8_t buf[sizeof(payload_t) + PAD_MAX];
+	unsigned long fulls = 0;
+	unsigned long attempts = 0;
+	payload_t p;
+	size_t i;
+	
+	p.producer = (uintptr_t)arg;
+	for(p.seq=0; p.seq<n_events; p.seq++){
+		for(i=0; i<PAD_SIZE(p.seq); i++){
+			buf[sizeof(p) + i] = p.seq + i;
+		}
+		
+		while(1){
+			attempts++;
+			p.timestamp = now_ns();
+			memcpy(buf, &p, sizeof(p));
+			if(event_PushEvent(onBenchEvent, buf, sizeof(p) + PAD_SIZE(p.seq)) == RES_OK){
+				break;
+			}
+			fulls++;
+			sched_yield();
+		}
+	}
+	
+	__atomic_fetch_add(&total_fulls, fulls, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&total_attempts, attempts, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&producers_done, 1, __ATOMIC_RELEASE);
+	return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[]){
+	pthread_t *threads;
+	unsigned long total;
+	uint64_t start, elapsed;
+	uint64_t sum = 0;
+	unsigned long i;
+	
+	if(argc > 1 && strcmp(argv[1], "-H") == 0){
+		printf("queue_size,producers,events,events_per_sec,mean_latency_ns,p99_latency_ns,"
+				"full_rate,errors\n");
+		return(0);
+	}
+	
+	if(argc > 1) n_producers = strtoul(argv[1], NULL, 0);
+	if(argc > 2) n_events = strtoul(argv[2], NULL, 0);
+	total = n_producers * n_events;
+	
+	threads = calloc(n_producers, sizeof(pthread_t));
+	next_seq = calloc(n_producers, sizeof(uint32_t));
+	latency = malloc(total * sizeof(uint64_t));
+	if(!threads || !next_seq || !latency){
+		fprintf(stderr, "Out of memory\n");
+		return(1);
+	}
+	
+	event_init();
+	
+	start = now_ns();
+	for(i=0; i<n_producers; i++){
+		pthread_create(&threads[i], NULL, producer, (void*)(uintptr_t)i);
+	}
+	
+	// Event handler loop runs on the main thread until every event has been dispatched
+	if(!setjmp(handler_exit)){
+		event_StartHandler();
+	}
+	elapsed = now_ns() - start;
+	
+	for(i=0; i<n_producers; i++){
+		pthread_join(threads[i], NULL);
+	}
+	
+	if(received != total){
+		errors++;
+	}
+	
+	for(i=0; i<received; i++){
+		sum += latency[i];
+	}
+	qsort(latency, received, sizeof(uint64_t), cmp_u64);
+	
+	printf("%u,%u,%lu,%.0f,%.0f,%llu,%.4f,%lu\n",
+			EVENT_QUEUE_SIZE, n_producers, total,
+			received / (elapsed / 1e9),
+			received ? (double)sum / received : 0.0,
+			received ? (unsigned long long)latency[(received*99)/100] : 0ULL,
+			total_attempts ? (double)total_fulls / total_attempts : 0.0,
+			errors);
+	
+	free(latency);
+	free(next_seq);
+	free(threads);
+	
+	if(errors){
+		return(1);
+	}
+	return(0);
+}
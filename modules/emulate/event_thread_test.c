@@ -0,0 +1,117 @@
+
+// Test for threaded event handlers (EVENT_COTHREADS > 0).
+// A handler registered with event_SetThreaded() yields several times per call and is dispatched
+// again while an earlier call is suspended. The calls must never overlap: each one runs to the end
+// before the next one starts, and the stale resume events left in the queue must not restart a
+// finished call. A plain handler queued in between checks that yields still let other events run.
+//
+// Build:
+//   gcc -std=gnu99 -O2 -Wall -pthread -I test_config -I target_shim -I. -idirafter ../../include -DEVENT_COTHREADS=2 event_thread_test.c ../event_queue.c fifo.c cothread.c -o event_thread_test
+
+#include <stdio.h>
+#include <stdint.h>
+#include <setjmp.h>
+
+#include <event_queue.h>
+
+#define YIELDS		3
+#define CALLS		3
+
+unsigned long errors;
+
+int running;
+int max_running;
+int started;
+int finished;
+int yields;
+int plain_calls;
+int plain_between;
+
+//--------------------------------------------------------------------------------------------------
+static void check(int ok, const char *what){
+	if(!ok){
+		printf("Failed: %s\n", what);
+		errors++;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+static jmp_buf idle_jmp;
+
+void onIdle(void){
+	longjmp(idle_jmp, 1);
+}
+
+// Runs the event queue until it is empty
+static void run_events(void){
+	if(!setjmp(idle_jmp)){
+		event_StartHandler();
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+static void plain(void){
+	plain_calls++;
+	if(running){
+		plain_between++;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+static void threaded(void){
+	int i;
+
+	running++;
+	if(running > max_running){
+		max_running = running;
+	}
+	started++;
+	check(finished == started - 1, "previous call finished before the next one starts");
+
+	for(i=0; i<YIELDS; i++){
+		event_YieldEvent();
+		yields++;
+	}
+
+	finished++;
+	running--;
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(void){
+	int i;
+
+	event_init();
+	check(event_SetThreaded(threaded) == RES_OK, "register threaded handler");
+
+	// One call on its own: yields let the plain handler run while it is suspended
+	event_PushEvent(threaded, NULL, 0);
+	event_PushEvent(plain, NULL, 0);
+	run_events();
+	check(finished == 1, "single call finishes");
+	check(plain_between == 1, "plain handler runs while the threaded one is suspended");
+
+	// Several calls queued back to back. Each dispatch finds the previous call suspended.
+	for(i=0; i<CALLS; i++){
+		event_PushEvent(threaded, NULL, 0);
+	}
+	run_events();
+	check(started == CALLS + 1, "every call starts");
+	check(finished == CALLS + 1, "every call finishes");
+	check(yields == (CALLS + 1) * YIELDS, "every yield returns once");
+	check(max_running == 1, "calls never overlap");
+	check(running == 0, "nothing left suspended");
+
+	// A later call must not be resumed by stale events of the earlier ones
+	event_PushEvent(threaded, NULL, 0);
+	event_PushEvent(plain, NULL, 0);
+	run_events();
+	check(finished == CALLS + 2, "call after stale resumes finishes");
+	check(max_running == 1, "calls never overlap after stale resumes");
+
+	printf("event_thread (EVENT_COTHREADS=%d): %lu errors\n", EVENT_COTHREADS, errors);
+	if(errors){
+		return(1);
+	}
+	return(0);
+}
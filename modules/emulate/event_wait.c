@@ -0,0 +1,43 @@
+
+// Host-side wait/wake used by the event queue when EVENT_IDLE_SLEEP is 2.
+// The waiter only blocks if no wakeup happened since it sampled the counter, so wakeups are never
+// lost. Pushes only bump the counter with an atomic increment. The mutex and condition variable
+// are only touched while the handler is actually waiting, so busy producers are not serialized.
+// The counter and the Waiting flag are sequentially consistent: either a waker sees Waiting set
+// and signals under the mutex, or the waiter sees the new count and does not block.
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "event_wait.h"
+
+static pthread_mutex_t WaitLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t WaitCond = PTHREAD_COND_INITIALIZER;
+static uint32_t Wakeups;
+static int Waiting;	// The handler is in event_emu_wait()
+
+//--------------------------------------------------------------------------------------------------
+void event_emu_wake(void){
+	__atomic_add_fetch(&Wakeups, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&Waiting, __ATOMIC_SEQ_CST)){
+		pthread_mutex_lock(&WaitLock);
+		pthread_cond_broadcast(&WaitCond);
+		pthread_mutex_unlock(&WaitLock);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+uint32_t event_emu_wakeups(void){
+	return(__atomic_load_n(&Wakeups, __ATOMIC_SEQ_CST));
+}
+
+//--------------------------------------------------------------------------------------------------
+void event_emu_wait(uint32_t seen){
+	pthread_mutex_lock(&WaitLock);
+	__atomic_store_n(&Waiting, 1, __ATOMIC_SEQ_CST);
+	while(__atomic_load_n(&Wakeups, __ATOMIC_SEQ_CST) == seen){
+		pthread_cond_wait(&WaitCond, &WaitLock);
+	}
+	__atomic_store_n(&Waiting, 0, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&WaitLock);
+}
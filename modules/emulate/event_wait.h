@@ -0,0 +1,30 @@
+
+// Host-side wait/wake used by the event queue when EVENT_IDLE_SLEEP is 2.
+// The event handler thread blocks in event_emu_wait() instead of spinning in onIdle(), and every
+// successful push calls event_emu_wake().
+
+#ifndef EVENT_WAIT_H
+#define EVENT_WAIT_H
+
+#include <stdint.h>
+
+/**
+* \brief Wakes the event handler thread
+* \details Called by the event queue after every push. It only takes a lock while the handler is
+*   waiting, so it is cheap while the handler is busy. Other threads can also call it to make the
+*   event handler call onIdle() again, for example to let it notice a shutdown request.
+**/
+void event_emu_wake(void);
+
+/**
+* \brief Returns the number of wakeups so far
+* \details Read this before checking whether the queue is empty, then pass it to event_emu_wait().
+**/
+uint32_t event_emu_wakeups(void);
+
+/**
+* \brief Blocks until the wakeup count differs from \c seen
+**/
+void event_emu_wait(uint32_t seen);
+
+#endif
@@ -43,6 +43,8 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <result.h>
 
@@ -50,7 +52,194 @@
 
 #include "fifo.h"
 
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+// The emulated FIFO may be accessed from several host threads at once (timer threads created by
+// emu_timer_sigev() as well as the main event loop). Instead of a lock, the FIFO uses the gcc
+// __atomic builtins, which follow the C11 memory model:
+//	- rdidx is only written by the reader. It is published with release semantics so that a writer
+//	  that sees the new value will not overwrite bytes that are still being copied out.
+//	- Writers claim space by advancing residx with a compare-and-swap and copy their data. They then
+//	  store the end index of their span in marks[start % bufsize], which is the commit marker.
+//	- wridx is advanced over consecutive committed spans by whichever writer finds them. A span that
+//	  is still being copied stops it there. Its own writer moves wridx on once it commits.
+//	- The reader snapshots wridx with acquire semantics, so all bytes below it are visible.
+// A marker belongs to the span starting at idx only if it lies in (idx, idx + bufsize). Older
+// markers at the same offset are from earlier laps and are always <= idx, so they never need to
+// be cleared.
+// All indexes are free-running. Only (idx % bufsize) is used to address the buffer, and one byte
+// is always left empty to match the capacity of the MSP430 implementation.
+
+#if(FIFO_EMU_USE_MUTEX == 1)
+	#define FIFO_LOCK(fifo)		pthread_mutex_lock(&(fifo)->lock)
+	#define FIFO_UNLOCK(fifo)	pthread_mutex_unlock(&(fifo)->lock)
+#else
+	#define FIFO_LOCK(fifo)
+	#define FIFO_UNLOCK(fifo)
+#endif
+
+#define LOAD(x, order)		__atomic_load_n(&(x), order)
+#define STORE(x, v, order)	__atomic_store_n(&(x), v, order)
+
+//--------------------------------------------------------------------------------------------------
+static void copy_in(FIFO_t *fifo, size_t idx, const uint8_t *src, size_t size){
+	size_t offset = idx % fifo->bufsize;
+	size_t count;
+	
+	if((count = fifo->bufsize - offset) < size){
+		// write operation will wrap around in fifo
+		memcpy(fifo->bufptr+offset,src,count);
+		offset = 0;
+		size -= count;
+		src += count;
+	}
+	memcpy(fifo->bufptr+offset,src,size);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void copy_out(FIFO_t *fifo, size_t idx, uint8_t *dst, size_t size){
+	size_t offset = idx % fifo->bufsize;
+	size_t count;
+	
+	if(dst == NULL) return;
+	
+	if((count = fifo->bufsize - offset) < size){
+		// read operation will wrap around in fifo
+		memcpy(dst,fifo->bufptr+offset,count);
+		offset = 0;
+		size -= count;
+		dst += count;
+	}
+	memcpy(dst,fifo->bufptr+offset,size);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void log_max(FIFO_t *fifo, size_t used){
+	#if(FIFO_LOG_MAX_USAGE == 1)
+		size_t max = LOAD(fifo->max, __ATOMIC_RELAXED);
+		while(used > max){
+			if(__atomic_compare_exchange_n(&fifo->max, &max, used, 1,
+											__ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+		}
+	#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+// Claims size bytes of space for a writer. Returns 0 if there is not enough room.
+static int claim(FIFO_t *fifo, size_t size, size_t *start){
+	size_t residx, rdidx;
+	
+	residx = LOAD(fifo->residx, __ATOMIC_RELAXED);
+	do{
+		rdidx = LOAD(fifo->rdidx, __ATOMIC_ACQUIRE);
+		if(size > (fifo->bufsize - 1) - (residx - rdidx)){
+			return(0);
+		}
+	}while(!__atomic_compare_exchange_n(&fifo->residx, &residx, residx + size, 1,
+										__ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	*start = residx;
+	return(1);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Commits a claimed span and advances wridx over all committed spans in front of it. Does not
+// wait: if an earlier span is still being copied, its writer advances wridx over this one later.
+// The marker store and the wridx accesses are sequentially consistent, so either this writer sees
+// wridx reach its span, or the writer that moves wridx there sees the marker.
+static void publish(FIFO_t *fifo, size_t start, size_t size){
+	size_t wridx, end, mark;
+	
+	if(size == 0) return;
+	
+	STORE(fifo->marks[start % fifo->bufsize], start + size, __ATOMIC_SEQ_CST);
+	
+	wridx = LOAD(fifo->wridx, __ATOMIC_SEQ_CST);
+	while(1){
+		end = wridx;
+		while(1){
+			mark = LOAD(fifo->marks[end % fifo->bufsize], __ATOMIC_SEQ_CST);
+			if((mark - end - 1) >= (fifo->bufsize - 1)) break; // Not committed yet
+			end = mark;
+		}
+		if(end == wridx) break;
+		
+		if(__atomic_compare_exchange_n(&fifo->wridx, &wridx, end, 0,
+										__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)){
+			log_max(fifo, end - LOAD(fifo->rdidx, __ATOMIC_RELAXED));
+			// Spans committed in the meantime may have seen the old wridx and left it to us
+			wridx = end;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Commit markers are kept per buffer so that initializing the same FIFO again (event_init() does
+// this) reuses them instead of allocating new ones.
+typedef struct marks_alloc {
+	void *bufptr;
+	size_t bufsize;
+	size_t *marks;
+	struct marks_alloc *next;
+} marks_alloc_t;
+
+static marks_alloc_t *MarksList;
+static pthread_mutex_t MarksLock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t *get_marks(void *bufptr, size_t bufsize){
+	marks_alloc_t *m;
+	
+	pthread_mutex_lock(&MarksLock);
+	for(m = MarksList; m; m = m->next){
+		if((m->bufptr == bufptr) && (m->bufsize == bufsize)) break;
+	}
+	if(m){
+		// Indexes start over at 0, so markers from before must not look committed
+		memset(m->marks, 0, bufsize*sizeof(size_t));
+	}else{
+		m = malloc(sizeof(marks_alloc_t));
+		if(m) m->marks = calloc(bufsize ? bufsize : 1, sizeof(size_t));
+		if((m == NULL) || (m->marks == NULL)){
+			fprintf(stderr, "fifo: can't allocate commit markers\n");
+			abort();
+		}
+		m->bufptr = bufptr;
+		m->bufsize = bufsize;
+		m->next = MarksList;
+		MarksList = m;
+	}
+	pthread_mutex_unlock(&MarksLock);
+	
+	return(m->marks);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void put_marks(size_t *marks){
+	marks_alloc_t **pm;
+	marks_alloc_t *m;
+	
+	pthread_mutex_lock(&MarksLock);
+	for(pm = &MarksList; *pm; pm = &(*pm)->next){
+		if((*pm)->marks == marks){
+			m = *pm;
+			*pm = m->next;
+			free(m->marks);
+			free(m);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&MarksLock);
+}
+
 //--------------------------------------------------------------------------------------------------
+// Only called by the reader, so rdidx can not change underneath it
+static size_t used_count(FIFO_t *fifo){
+	return(LOAD(fifo->wridx, __ATOMIC_ACQUIRE) - LOAD(fifo->rdidx, __ATOMIC_RELAXED));
+}
+
+//==================================================================================================
+// Functions
+//==================================================================================================
 ///\addtogroup FIFO_FUNCTIONS
 ///\{
 
@@ -67,16 +256,39 @@ void fifo_init(FIFO_t *fifo, void *bufptr, size_t bufsize){
 	fifo->bufsize = bufsize;
 	fifo->rdidx = 0;
 	fifo->wridx = 0;
+	fifo->residx = 0;
+	fifo->marks = get_marks(bufptr, bufsize);
 	#if(FIFO_LOG_MAX_USAGE == 1)
 		fifo->max = 0;
 	#endif
-	fifo->lock = PTHREAD_MUTEX_INITIALIZER;
-	pthread_mutex_init(&fifo->lock,NULL);
+	#if(FIFO_EMU_USE_MUTEX == 1)
+		pthread_mutex_init(&fifo->lock,NULL);
+	#endif
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Frees the commit markers of a FIFO
+* \details Only exists in the emulated FIFO. Call it before the FIFO's buffer goes out of scope or
+* is freed. No other thread may be using the FIFO. It can be initialized again afterwards.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \return Nothing
+**/
+void fifo_uninit(FIFO_t *fifo){
+	if(fifo->marks){
+		put_marks(fifo->marks);
+		fifo->marks = NULL;
+	}
+	#if(FIFO_EMU_USE_MUTEX == 1)
+		pthread_mutex_destroy(&fifo->lock);
+	#endif
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
 * \brief Write data into the FIFO buffer
+* \details Safe to call from several threads at once.
 * \param [in] fifo Pointer to the #FIFO_t object
 * \param [in] src Pointer to the data to be stored
 * \param [in] size Number of bytes to be written to the FIFO
@@ -84,39 +296,54 @@ void fifo_init(FIFO_t *fifo, void *bufptr, size_t bufsize){
 * \retval RES_FULL Not enough space in FIFO for requested write operation
 **/
 RES_t fifo_write(FIFO_t *fifo, void *src, size_t size){
-	size_t wrcount;
-
-	pthread_mutex_lock(&fifo->lock);
+	size_t start;
 	
-	if(size > fifo_wrcount(fifo)){
-		pthread_mutex_unlock(&fifo->lock);
+	FIFO_LOCK(fifo);
+	if(!claim(fifo, size, &start)){
+		FIFO_UNLOCK(fifo);
 		return(RES_FULL);
 	}
+	copy_in(fifo, start, src, size);
+	publish(fifo, start, size);
+	FIFO_UNLOCK(fifo);
+	
+	return(RES_OK);
+}
 
-	if((wrcount = fifo->bufsize - fifo->wridx) <= size){
-		// write operation will wrap around in fifo
-		// write first half of fifo
-		memcpy(fifo->bufptr+fifo->wridx,src,wrcount);
-		
-		//wrap around and continue
-		fifo->wridx = 0;
-		size -= wrcount;
-		src = (uint8_t*)src + wrcount;
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Write several segments of data into the FIFO buffer as one operation
+* \details Safe to call from several threads at once. The segments are never interleaved with data
+* from another writer.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] iov Array of segments to be stored
+* \param [in] iovcnt Number of segments in \c iov
+* \retval RES_OK 
+* \retval RES_FULL Not enough space in FIFO for requested write operation
+**/
+RES_t fifo_writev(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt){
+	size_t total = 0;
+	size_t start, idx;
+	size_t i;
+	
+	for(i=0;i<iovcnt;i++){
+		total += iov[i].len;
 	}
-
-	if(size > 0){
-		memcpy(fifo->bufptr+fifo->wridx,src,size);
-		fifo->wridx += size;
+	
+	FIFO_LOCK(fifo);
+	if(!claim(fifo, total, &start)){
+		FIFO_UNLOCK(fifo);
+		return(RES_FULL);
 	}
 	
-	#if(FIFO_LOG_MAX_USAGE == 1)
-		wrcount = fifo_rdcount(fifo);
-		if(wrcount > fifo->max){
-			fifo->max = wrcount;
-		}
-	#endif
+	idx = start;
+	for(i=0;i<iovcnt;i++){
+		copy_in(fifo, idx, iov[i].buf, iov[i].len);
+		idx += iov[i].len;
+	}
 	
-	pthread_mutex_unlock(&fifo->lock);
+	publish(fifo, start, total);
+	FIFO_UNLOCK(fifo);
 	
 	return(RES_OK);
 }
@@ -131,38 +358,82 @@ RES_t fifo_write(FIFO_t *fifo, void *src, size_t size){
 * \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
 **/
 RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size){
-	size_t rdcount;
-	
-	pthread_mutex_lock(&fifo->lock);
+	size_t rdidx;
 	
-	if(size > fifo_rdcount(fifo)){
-		pthread_mutex_unlock(&fifo->lock);
+	FIFO_LOCK(fifo);
+	if(size > used_count(fifo)){
+		FIFO_UNLOCK(fifo);
 		return(RES_PARAMERR);
 	}
 	
-	if((rdcount = fifo->bufsize - fifo->rdidx) <= size){
-		// read operation will wrap around in fifo
-		// read first half of fifo
-		if(dst != NULL){
-			memcpy(dst,fifo->bufptr+fifo->rdidx,rdcount);
-		}
-		//wrap around and continue
-		fifo->rdidx = 0;
-		size -= rdcount;
-		dst = (uint8_t*)dst + rdcount;
+	rdidx = LOAD(fifo->rdidx, __ATOMIC_RELAXED);
+	copy_out(fifo, rdidx, dst, size);
+	STORE(fifo->rdidx, rdidx + size, __ATOMIC_RELEASE);
+	FIFO_UNLOCK(fifo);
+	
+	return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Read data from the FIFO buffer into several segments as one operation
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] iov Array of segments to be filled. A segment with a \c NULL \c buf discards its data.
+* \param [in] iovcnt Number of segments in \c iov
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+**/
+RES_t fifo_readv(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt){
+	size_t total = 0;
+	size_t rdidx;
+	size_t i;
+	
+	for(i=0;i<iovcnt;i++){
+		total += iov[i].len;
 	}
 	
-	if(size > 0){
-		if(dst != NULL){
-			memcpy(dst,fifo->bufptr+fifo->rdidx,size);
-		}
-		fifo->rdidx += size;
+	FIFO_LOCK(fifo);
+	if(total > used_count(fifo)){
+		FIFO_UNLOCK(fifo);
+		return(RES_PARAMERR);
 	}
 	
-	pthread_mutex_unlock(&fifo->lock);
+	rdidx = LOAD(fifo->rdidx, __ATOMIC_RELAXED);
+	for(i=0;i<iovcnt;i++){
+		copy_out(fifo, rdidx, iov[i].buf, iov[i].len);
+		rdidx += iov[i].len;
+	}
+	STORE(fifo->rdidx, rdidx, __ATOMIC_RELEASE);
+	FIFO_UNLOCK(fifo);
 	
 	return(RES_OK);
 }
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Read up to \c max_size bytes from the FIFO buffer
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read.
+* \param [in] max_size Maximum number of bytes to be read from the FIFO
+* \return Number of bytes that were read
+**/
+size_t fifo_read_max(FIFO_t *fifo, void *dst, size_t max_size){
+	size_t rdidx, size;
+	
+	FIFO_LOCK(fifo);
+	size = used_count(fifo);
+	if(size > max_size){
+		size = max_size;
+	}
+	
+	rdidx = LOAD(fifo->rdidx, __ATOMIC_RELAXED);
+	copy_out(fifo, rdidx, dst, size);
+	STORE(fifo->rdidx, rdidx + size, __ATOMIC_RELEASE);
+	FIFO_UNLOCK(fifo);
+	
+	return(size);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
 * \brief Read data from the FIFO buffer without advancing the read pointer
@@ -173,49 +444,115 @@ RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size){
 * \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
 **/
 RES_t fifo_peek(FIFO_t *fifo, void *dst, size_t size){
-	size_t rdcount;
-	size_t rdidx;
-	
-	pthread_mutex_lock(&fifo->lock);
-	
-	if(size > fifo_rdcount(fifo)){
-		pthread_mutex_unlock(&fifo->lock);
+	FIFO_LOCK(fifo);
+	if(size > used_count(fifo)){
+		FIFO_UNLOCK(fifo);
 		return(RES_PARAMERR);
 	}
 	
-	rdidx = fifo->rdidx;
+	copy_out(fifo, LOAD(fifo->rdidx, __ATOMIC_RELAXED), dst, size);
+	FIFO_UNLOCK(fifo);
 	
-	if((rdcount = fifo->bufsize - rdidx) <= size){
-		// read operation will wrap around in fifo
-		// read first half of fifo
-		memcpy(dst,fifo->bufptr+rdidx,rdcount);
-		//wrap around and continue
-		rdidx = 0;
-		size -= rdcount;
-		dst = (uint8_t*)dst + rdcount;
-	}
+	return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Reserve a contiguous region of the FIFO buffer to be written in-place
+* \details The region is not claimed until fifo_write_commit(), so a FIFO that is written in-place
+* must have no other producer. Any fifo_write() or fifo_writev() that runs between the reserve and
+* the commit claims the same region and overwrites the data, and the commit then publishes whatever
+* region is next. Only one thread may use fifo_write_reserve() / fifo_write_commit() on a given FIFO.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] size Number of contiguous bytes that can be written at the returned pointer
+* \return Pointer to the reserved region
+**/
+void *fifo_write_reserve(FIFO_t *fifo, size_t *size){
+	size_t residx, offset, wrfree;
 	
-	if(size > 0){
-		memcpy(dst,fifo->bufptr+rdidx,size);
-		rdidx += size;
+	FIFO_LOCK(fifo);
+	residx = LOAD(fifo->residx, __ATOMIC_RELAXED);
+	wrfree = (fifo->bufsize - 1) - (residx - LOAD(fifo->rdidx, __ATOMIC_ACQUIRE));
+	FIFO_UNLOCK(fifo);
+	
+	offset = residx % fifo->bufsize;
+	*size = fifo->bufsize - offset;
+	if(*size > wrfree){
+		*size = wrfree;
 	}
 	
-	pthread_mutex_unlock(&fifo->lock);
+	return(fifo->bufptr + offset);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Publish data that was written in-place after a call to fifo_write_reserve()
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] size Number of bytes to publish
+* \retval RES_OK 
+* \retval RES_PARAMERR \c size is larger than the contiguous region that was reserved
+**/
+RES_t fifo_write_commit(FIFO_t *fifo, size_t size){
+	size_t start;
+	
+	FIFO_LOCK(fifo);
+	start = LOAD(fifo->residx, __ATOMIC_RELAXED);
+	if((size > fifo->bufsize - (start % fifo->bufsize)) || !claim(fifo, size, &start)){
+		FIFO_UNLOCK(fifo);
+		return(RES_PARAMERR);
+	}
+	publish(fifo, start, size);
+	FIFO_UNLOCK(fifo);
 	
 	return(RES_OK);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Get a pointer to the contiguous readable data at the front of the FIFO
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] size Number of contiguous bytes that can be read at the returned pointer
+* \return Pointer to the oldest unread byte in the FIFO
+**/
+void *fifo_read_peek_contig(FIFO_t *fifo, size_t *size){
+	size_t offset, used;
+	
+	FIFO_LOCK(fifo);
+	used = used_count(fifo);
+	offset = LOAD(fifo->rdidx, __ATOMIC_RELAXED) % fifo->bufsize;
+	FIFO_UNLOCK(fifo);
+	
+	*size = fifo->bufsize - offset;
+	if(*size > used){
+		*size = used;
+	}
+	
+	return(fifo->bufptr + offset);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Release data from the front of the FIFO without copying it
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] size Number of bytes to discard
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested operation
+**/
+RES_t fifo_read_consume(FIFO_t *fifo, size_t size){
+	return(fifo_read(fifo, NULL, size));
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
 * \brief Empties the FIFO
+* \details Must be called by the reader. Data that is still being written is not discarded.
 * \param [in] fifo Pointer to the #FIFO_t object
 * \return Nothing
 **/
 void fifo_clear(FIFO_t *fifo){
-	pthread_mutex_lock(&fifo->lock);
-	fifo->rdidx = 0;
-	fifo->wridx = 0;
-	pthread_mutex_unlock(&fifo->lock);
+	FIFO_LOCK(fifo);
+	STORE(fifo->rdidx, LOAD(fifo->wridx, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+	FIFO_UNLOCK(fifo);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -225,17 +562,8 @@ void fifo_clear(FIFO_t *fifo){
 * \return Number of bytes
 **/
 size_t fifo_rdcount(FIFO_t *fifo){
-	size_t wridx,rdidx;
-	pthread_mutex_lock(&fifo->lock);
-	wridx = fifo->wridx;
-	rdidx = fifo->rdidx;
-	pthread_mutex_unlock(&fifo->lock);
-	
-	if(wridx >= rdidx){
-		return(wridx-rdidx);
-	}else{
-		return((fifo->bufsize-rdidx)+wridx);
-	}
+	size_t rdidx = LOAD(fifo->rdidx, __ATOMIC_ACQUIRE);
+	return(LOAD(fifo->wridx, __ATOMIC_ACQUIRE) - rdidx);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -245,17 +573,91 @@ size_t fifo_rdcount(FIFO_t *fifo){
 * \return Number of bytes
 **/
 size_t fifo_wrcount(FIFO_t *fifo){
-	size_t wridx,rdidx;
-	pthread_mutex_lock(&fifo->lock);
-	wridx = fifo->wridx;
-	rdidx = fifo->rdidx;
-	pthread_mutex_unlock(&fifo->lock);
-	
-	if(fifo->rdidx >= fifo->wridx+1){
-		return(rdidx-wridx-1);
-	}else{
-		return((fifo->bufsize-wridx)+rdidx-1);
+	size_t residx = LOAD(fifo->residx, __ATOMIC_ACQUIRE);
+	size_t used = residx - LOAD(fifo->rdidx, __ATOMIC_ACQUIRE);
+	
+	// The reader may have advanced past a stale residx snapshot
+	if(used > fifo->bufsize - 1){
+		return(0);
 	}
+	return((fifo->bufsize - 1) - used);
+}
+
+//==================================================================================================
+// Single-Producer/Single-Consumer Functions
+//==================================================================================================
+// The regular functions are already lock-free. With only one producer, the compare-and-swap and
+// the commit markers can be skipped. Don't use them while another thread uses the regular write
+// functions on the same FIFO.
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Write data into the FIFO buffer (producer only)
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] src Pointer to the data to be stored
+* \param [in] size Number of bytes to be written to the FIFO
+* \retval RES_OK 
+* \retval RES_FULL Not enough space in FIFO for requested write operation
+**/
+RES_t fifo_spsc_write(FIFO_t *fifo, void *src, size_t size){
+	size_t wridx;
+	
+	wridx = LOAD(fifo->wridx, __ATOMIC_RELAXED);
+	if(size > (fifo->bufsize - 1) - (wridx - LOAD(fifo->rdidx, __ATOMIC_ACQUIRE))){
+		return(RES_FULL);
+	}
+	
+	copy_in(fifo, wridx, src, size);
+	STORE(fifo->residx, wridx + size, __ATOMIC_RELAXED);
+	STORE(fifo->wridx, wridx + size, __ATOMIC_RELEASE);
+	
+	return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Read data from the FIFO buffer (consumer only)
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read. A \c NULL pointer discards the data.
+* \param [in] size Number of bytes to be read from the FIFO
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+**/
+RES_t fifo_spsc_read(FIFO_t *fifo, void *dst, size_t size){
+	return(fifo_read(fifo, dst, size));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Read data from the FIFO buffer without advancing the read pointer (consumer only)
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read.
+* \param [in] size Number of bytes to be read from the FIFO
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+**/
+RES_t fifo_spsc_peek(FIFO_t *fifo, void *dst, size_t size){
+	return(fifo_peek(fifo, dst, size));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Get the number of bytes available for read in the FIFO
+* \param [in] fifo Pointer to the #FIFO_t object
+* \return Number of bytes
+**/
+size_t fifo_spsc_rdcount(FIFO_t *fifo){
+	return(fifo_rdcount(fifo));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+* \brief Get the number of bytes that can be written to the FIFO
+* \param [in] fifo Pointer to the #FIFO_t object
+* \return Number of bytes
+**/
+size_t fifo_spsc_wrcount(FIFO_t *fifo){
+	return(fifo_wrcount(fifo));
 }
 
 ///\}
@@ -30,6 +30,19 @@
 *
 * This module creates a generic First-in First-out buffer.
 *
+* The emulated FIFO is lock-free. Any number of threads may write to a FIFO, but only one thread may
+* read from it (for the event queue, this is the thread running event_StartHandler()). Writers claim
+* space with a compare-and-swap, copy their data, and then mark their span as written. The reader
+* only sees data up to the first span that is still being copied. A writer never waits for another
+* one: whichever writer finds the spans in front of the reader complete makes them visible.
+*
+* fifo_write_reserve() / fifo_write_commit() don't claim their space until the commit, so a FIFO
+* that is written in-place must have no other writer.
+*
+* fifo_init() allocates one commit marker per buffer byte for this. They are kept for the buffer and
+* reused if the FIFO is initialized again. A FIFO whose buffer is on the heap or on a thread's stack
+* must be released with fifo_uninit() before the buffer goes away. It is only needed on the host.
+*
 * <b> Compilers Supported: </b>
 *	- Any C89 compatible or newer
 *
@@ -60,6 +73,14 @@
  * in a given FIFO. Use this to determine how large your buffer should be.
 **/
 
+#ifndef FIFO_EMU_USE_MUTEX
+	#define FIFO_EMU_USE_MUTEX	0
+#endif
+/**<
+ * When set to 1, every FIFO operation is also serialized with a pthread mutex. This is only
+ * intended as a baseline for benchmarking the lock-free implementation.
+**/
+
 //==================================================================================================
 // Struct Typedefs
 //==================================================================================================
@@ -68,14 +89,25 @@
 typedef struct {
 	uint8_t *bufptr;	// pointer to the buffer array
 	size_t bufsize;	// size of buffer
-	size_t rdidx;	// points to next address to be read
-	size_t wridx;	// points to next address to be written
+	// Indexes are free-running byte counts. Buffer offsets are taken modulo bufsize.
+	size_t rdidx;	// next byte to be read. Only written by the reader.
+	size_t wridx;	// end of the data that has been published to the reader
+	size_t residx;	// end of the space that has been claimed by writers
+	size_t *marks;	// marks[start % bufsize] is set to the end index of a span once it is written
 	#if(FIFO_LOG_MAX_USAGE == 1)
 		size_t max;
 	#endif
-	pthread_mutex_t lock;
+	#if(FIFO_EMU_USE_MUTEX == 1)
+		pthread_mutex_t lock;
+	#endif
 } FIFO_t;
 
+// Data segment for fifo_writev() and fifo_readv()
+struct fifo_iov {
+	void *buf;	// pointer to the segment's data
+	size_t len;	// size of the segment in bytes
+};
+
 //==================================================================================================
 // Function Prototypes
 //==================================================================================================
@@ -83,13 +115,30 @@ typedef struct {
 ///\{
 
 void fifo_init(FIFO_t *fifo, void *bufptr, size_t bufsize);
+void fifo_uninit(FIFO_t *fifo); // Frees the commit markers. Emulation only.
 RES_t fifo_write(FIFO_t *fifo, void *src, size_t size);
+RES_t fifo_writev(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt);
 RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size);
+RES_t fifo_readv(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt);
+size_t fifo_read_max(FIFO_t *fifo, void *dst, size_t max_size);
 RES_t fifo_peek(FIFO_t *fifo, void *dst, size_t size);
+void *fifo_write_reserve(FIFO_t *fifo, size_t *size);
+RES_t fifo_write_commit(FIFO_t *fifo, size_t size);
+void *fifo_read_peek_contig(FIFO_t *fifo, size_t *size);
+RES_t fifo_read_consume(FIFO_t *fifo, size_t size);
 void fifo_clear(FIFO_t *fifo);
 size_t fifo_rdcount(FIFO_t *fifo); // Returns the number of bytes currently stored in the FIFO
 size_t fifo_wrcount(FIFO_t *fifo); // Returns the number of bytes free in the FIFO
 
+RES_t fifo_spsc_write(FIFO_t *fifo, void *src, size_t size);
+RES_t fifo_spsc_read(FIFO_t *fifo, void *dst, size_t size);
+RES_t fifo_spsc_peek(FIFO_t *fifo, void *dst, size_t size);
+size_t fifo_spsc_rdcount(FIFO_t *fifo);
+size_t fifo_spsc_wrcount(FIFO_t *fifo);
+
+// FIFO telemetry is not emulated
+#define fifo_register(fifo, name)   ((void)(fifo), (void)(name))
+
 ///\}
 
 #endif
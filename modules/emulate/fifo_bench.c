@@ -0,0 +1,133 @@
+
+// Micro-benchmark for the emulated FIFO.
+// Several producer threads push timestamped messages into one FIFO while a single consumer thread
+// pops them. Reports throughput and the latency from push to pop.
+//
+// Build and compare the lock-free and mutex implementations:
+//   gcc -std=gnu99 -O2 -pthread -I. -idirafter ../../include fifo_bench.c fifo.c -o fifo_bench
+//   gcc -std=gnu99 -O2 -pthread -I. -idirafter ../../include -DFIFO_EMU_USE_MUTEX=1 fifo_bench.c fifo.c -o fifo_bench_mutex
+//
+// Usage:
+//   ./fifo_bench [producers] [messages per producer]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "fifo.h"
+
+typedef struct {
+	uint64_t timestamp;
+	uint32_t producer;
+	uint32_t seq;
+} msg_t;
+
+uint8_t fifo_buf[64*sizeof(msg_t)+1];
+FIFO_t fifo;
+
+unsigned int n_producers = 2;
+unsigned long n_messages = 1000000;
+
+//--------------------------------------------------------------------------------------------------
+static uint64_t now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec);
+}
+
+//--------------------------------------------------------------------------------------------------
+static int cmp_u64(const void *a, const void *b){
+	uint64_t x = *(const uint64_t*)a;
+	uint64_t y = *(const uint64_t*)b;
+	return((x > y) - (x < y));
+}
+
+//--------------------------------------------------------------------------------------------------
+void *producer(void *arg){
+	msg_t msg;
+	
+	msg.producer = (uintptr_t)arg;
+	for(msg.seq=0; msg.seq<n_messages; msg.seq++){
+		msg.timestamp = now_ns();
+		while(fifo_write(&fifo, &msg, sizeof(msg)) != RES_OK){
+			sched_yield();
+		}
+	}
+	return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(int argc, char *argv[]){
+	pthread_t *threads;
+	uint32_t *next_seq;
+	uint64_t *latency;
+	unsigned long total, received = 0;
+	unsigned long errors = 0;
+	uint64_t start, elapsed;
+	msg_t msg;
+	unsigned int i;
+	
+	if(argc > 1) n_producers = strtoul(argv[1], NULL, 0);
+	if(argc > 2) n_messages = strtoul(argv[2], NULL, 0);
+	total = n_producers * n_messages;
+	
+	threads = calloc(n_producers, sizeof(pthread_t));
+	next_seq = calloc(n_producers, sizeof(uint32_t));
+	latency = malloc(total * sizeof(uint64_t));
+	if(!threads || !next_seq || !latency){
+		fprintf(stderr, "Out of memory\n");
+		return(1);
+	}
+	
+	fifo_init(&fifo, fifo_buf, sizeof(fifo_buf));
+	
+	start = now_ns();
+	for(i=0; i<n_producers; i++){
+		pthread_create(&threads[i], NULL, producer, (void*)(uintptr_t)i);
+	}
+	
+	// Consumer runs on the main thread
+	while(received < total){
+		if(fifo_read(&fifo, &msg, sizeof(msg)) != RES_OK){
+			sched_yield();
+			continue;
+		}
+		latency[received++] = now_ns() - msg.timestamp;
+		
+		// Messages from each producer must arrive whole and in order
+		if(msg.producer >= n_producers || msg.seq != next_seq[msg.producer]){
+			errors++;
+		}else{
+			next_seq[msg.producer]++;
+		}
+	}
+	elapsed = now_ns() - start;
+	
+	for(i=0; i<n_producers; i++){
+		pthread_join(threads[i], NULL);
+	}
+	
+	qsort(latency, total, sizeof(uint64_t), cmp_u64);
+	
+	printf("%s FIFO: %u producers, %lu messages\n",
+			FIFO_EMU_USE_MUTEX ? "mutex" : "lock-free", n_producers, total);
+	printf("  %.0f ops/sec\n", total / (elapsed / 1e9));
+	printf("  latency p50 %llu ns, p99 %llu ns, max %llu ns\n",
+			(unsigned long long)latency[total/2],
+			(unsigned long long)latency[(total*99)/100],
+			(unsigned long long)latency[total-1]);
+	printf("  %lu errors\n", errors);
+	
+	fifo_uninit(&fifo);
+	free(latency);
+	free(next_seq);
+	free(threads);
+	
+	if(errors){
+		return(1);
+	}
+	return(0);
+}
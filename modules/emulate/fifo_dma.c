@@ -0,0 +1,159 @@
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <result.h>
+#include <fifo_dma_config.h>
+
+#include "fifo.h"
+#include "fifo_dma.h"
+
+#ifndef FIFO_DMA_THRESHOLD
+	#define FIFO_DMA_THRESHOLD	32
+#endif
+
+#ifndef FIFO_DMA_USE_EVENTS
+	#define FIFO_DMA_USE_EVENTS	0
+#endif
+
+#ifndef FIFO_DMA_EMU_DELAY_US
+	#define FIFO_DMA_EMU_DELAY_US	0
+#endif
+
+#if(FIFO_DMA_USE_EVENTS == 1)
+	#include <event_queue.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+// State of the transfer in progress
+static struct {
+	FIFO_t *fifo;
+	void *addr;
+	size_t size;
+	bool is_write;
+	void (*callback)(void);
+} xfer;
+
+static bool busy = false;
+
+//--------------------------------------------------------------------------------------------------
+static void complete(void (*callback)(void)){
+	if(callback){
+		#if(FIFO_DMA_USE_EVENTS == 1)
+			event_PushEvent(callback, NULL, 0);
+		#else
+			callback();
+		#endif
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Stands in for the DMA controller. The FIFO's index is published once at the end of the copy, just
+// like the firmware version does from the DMA ISR. fifo_write() and fifo_read() split the copy at
+// the wrap point the same way the two DMA blocks do.
+static void *dma_worker(void *arg){
+	void (*callback)(void) = xfer.callback;
+	
+	(void)arg;
+	
+	#if(FIFO_DMA_EMU_DELAY_US > 0)
+		usleep(FIFO_DMA_EMU_DELAY_US);
+	#endif
+	
+	if(xfer.is_write){
+		fifo_write(xfer.fifo, xfer.addr, xfer.size);
+	}else{
+		fifo_read(xfer.fifo, xfer.addr, xfer.size);
+	}
+	
+	__atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+	complete(callback);
+	
+	return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+static RES_t start(FIFO_t *fifo, void *addr, size_t size, bool is_write, void (*callback)(void)){
+	pthread_t thread;
+	bool expected = false;
+	
+	if(!__atomic_compare_exchange_n(&busy, &expected, true, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+		return(RES_BUSY);
+	}
+	
+	if(is_write && (size > fifo_wrcount(fifo))){
+		__atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+		return(RES_FULL);
+	}
+	if(!is_write && (size > fifo_rdcount(fifo))){
+		__atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+		return(RES_PARAMERR);
+	}
+	
+	xfer.fifo = fifo;
+	xfer.addr = addr;
+	xfer.size = size;
+	xfer.is_write = is_write;
+	xfer.callback = callback;
+	
+	if(pthread_create(&thread, NULL, dma_worker, NULL) != 0){
+		__atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+		return(RES_FAIL);
+	}
+	pthread_detach(thread);
+	
+	return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Copies a transfer below the threshold right away. The channel is claimed for the duration of the
+// copy, since a background transfer in progress would otherwise publish its index over it.
+static RES_t copy(FIFO_t *fifo, void *addr, size_t size, bool is_write, void (*callback)(void)){
+	bool expected = false;
+	RES_t res;
+	
+	if(!__atomic_compare_exchange_n(&busy, &expected, true, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+		return(RES_BUSY);
+	}
+	
+	if(is_write){
+		res = (fifo_write(fifo, addr, size) == RES_OK) ? RES_OK : RES_FULL;
+	}else{
+		res = (fifo_read(fifo, addr, size) == RES_OK) ? RES_OK : RES_PARAMERR;
+	}
+	
+	__atomic_store_n(&busy, false, __ATOMIC_RELEASE);
+	
+	if(res == RES_OK){
+		complete(callback);
+	}
+	return(res);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_dma_write(FIFO_t *fifo, const void *src, size_t size, void (*callback)(void)){
+	if(size < FIFO_DMA_THRESHOLD){
+		return(copy(fifo, (void*)src, size, true, callback));
+	}
+	
+	return(start(fifo, (void*)src, size, true, callback));
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_dma_read(FIFO_t *fifo, void *dst, size_t size, void (*callback)(void)){
+	if(size < FIFO_DMA_THRESHOLD){
+		return(copy(fifo, dst, size, false, callback));
+	}
+	
+	return(start(fifo, dst, size, false, callback));
+}
+
+//--------------------------------------------------------------------------------------------------
+bool fifo_dma_busy(void){
+	return(__atomic_load_n(&busy, __ATOMIC_ACQUIRE));
+}
@@ -0,0 +1,33 @@
+/**
+* \addtogroup MOD_FIFO_DMA
+* \{
+**/
+
+/**
+* \file
+* \brief Include file for the emulated \ref MOD_FIFO_DMA
+* \author Alex Mykyta 
+*
+* Each transfer is performed by a worker thread, which stands in for the DMA controller. The
+* completion callback is called from the worker thread, or queued as an event if
+* FIFO_DMA_USE_EVENTS is set to 1.
+*
+* Set FIFO_DMA_EMU_DELAY_US in fifo_dma_config.h to make each background transfer take that long.
+**/
+
+#ifndef FIFO_DMA_H
+#define FIFO_DMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <result.h>
+
+#include "fifo.h"
+
+RES_t fifo_dma_write(FIFO_t *fifo, const void *src, size_t size, void (*callback)(void));
+RES_t fifo_dma_read(FIFO_t *fifo, void *dst, size_t size, void (*callback)(void));
+bool fifo_dma_busy(void);
+
+#endif
+///\}
@@ -0,0 +1,38 @@
+/**
+* \addtogroup MOD_FIFO_DMA
+* \{
+**/
+
+/**
+* \file
+* \brief Configuration include file for the emulated \ref MOD_FIFO_DMA
+* \author Alex Mykyta
+**/
+
+#ifndef FIFO_DMA_CONFIG_H
+#define FIFO_DMA_CONFIG_H
+
+//==================================================================================================
+/// \name Configuration
+/// Configuration defines for the emulated \ref MOD_FIFO_DMA module
+/// \{
+//==================================================================================================
+
+/// Transfers smaller than this many bytes are copied right away
+#define FIFO_DMA_THRESHOLD  32    ///< \hideinitializer
+
+/// Select how the completion callback is run
+#define FIFO_DMA_USE_EVENTS 0    ///< \hideinitializer
+/**<    0 = The callback is called from the worker thread \n
+*       1 = The callback is queued using event_PushEvent()
+**/
+
+/// Time each background transfer takes, in microseconds
+#define FIFO_DMA_EMU_DELAY_US   0    ///< \hideinitializer
+/**<    Use it to test code that has to cope with transfers that are still in progress.
+**/
+
+///\}
+#endif
+
+///\}
@@ -0,0 +1,163 @@
+
+// Test for the emulated FIFO DMA transfers.
+// Covers transfers that wrap around the end of the FIFO buffer, the memcpy() path below
+// FIFO_DMA_THRESHOLD, RES_BUSY for transfers of any size while a transfer is in progress, the
+// RES_FULL and RES_PARAMERR checks, and delivery of the completion callback.
+// test_config/fifo_dma_config.h makes every background transfer take a while so that it can be
+// seen in progress.
+//
+// Build (callback from the worker thread, then as an event):
+//   gcc -std=gnu99 -O2 -Wall -pthread -I. -I test_config -idirafter ../../include fifo_dma_test.c fifo_dma.c fifo.c -o fifo_dma_test
+//   gcc -std=gnu99 -O2 -Wall -pthread -I. -I test_config -I bench_config -idirafter ../../include -DFIFO_DMA_USE_EVENTS=1 fifo_dma_test.c fifo_dma.c fifo.c ../event_queue.c -o fifo_dma_test_events
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <pthread.h>
+
+#include <fifo_dma_config.h>
+#include "fifo.h"
+#include "fifo_dma.h"
+
+#if(FIFO_DMA_USE_EVENTS == 1)
+	#include <event_queue.h>
+#endif
+
+// Odd size so that the wrap point is not aligned to anything
+uint8_t fifo_buf[101];
+FIFO_t fifo;
+
+uint8_t src[100];
+uint8_t dst[100];
+
+unsigned long errors;
+
+volatile int callbacks;
+volatile int callback_in_main;
+pthread_t main_thread;
+
+//--------------------------------------------------------------------------------------------------
+static void check(int ok, const char *what){
+	if(!ok){
+		printf("Failed: %s\n", what);
+		errors++;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+static void done(void){
+	if(pthread_equal(pthread_self(), main_thread)){
+		callback_in_main++;
+	}
+	__atomic_add_fetch(&callbacks, 1, __ATOMIC_SEQ_CST);
+}
+
+#if(FIFO_DMA_USE_EVENTS == 1)
+//--------------------------------------------------------------------------------------------------
+static jmp_buf idle_jmp;
+
+void onIdle(void){
+	longjmp(idle_jmp, 1);
+}
+
+// Runs the event queue until it is empty
+static void run_events(void){
+	if(!setjmp(idle_jmp)){
+		event_StartHandler();
+	}
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+// Waits for the background transfer and its callback
+static void wait_done(int expected_callbacks){
+	int in_main = callback_in_main;
+	int i;
+
+	for(i=0; (i<1000) && fifo_dma_busy(); i++){
+		usleep(1000);
+	}
+	check(!fifo_dma_busy(), "transfer completes");
+
+	#if(FIFO_DMA_USE_EVENTS == 1)
+		check(callbacks == expected_callbacks - 1, "callback waits for the event queue");
+		run_events();
+		check(callback_in_main == in_main + 1, "callback runs in the event handler");
+	#else
+		for(i=0; (i<1000) && (callbacks != expected_callbacks); i++){
+			usleep(1000);
+		}
+		check(callback_in_main == in_main, "callback runs in the worker thread");
+	#endif
+	check(callbacks == expected_callbacks, "callback called once");
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(void){
+	size_t i;
+
+	main_thread = pthread_self();
+	for(i=0; i<sizeof(src); i++){
+		src[i] = i + 1;
+	}
+
+	#if(FIFO_DMA_USE_EVENTS == 1)
+		event_init();
+	#endif
+	fifo_init(&fifo, fifo_buf, sizeof(fifo_buf));
+
+	// Move the indexes close to the end of the buffer
+	fifo_write(&fifo, src, 90);
+	fifo_read(&fifo, NULL, 90);
+
+	// Below the threshold: copied and completed before returning
+	check(fifo_dma_write(&fifo, src, FIFO_DMA_THRESHOLD-1, done) == RES_OK, "small write");
+	check(!fifo_dma_busy(), "small write is not in the background");
+	check(fifo_rdcount(&fifo) == FIFO_DMA_THRESHOLD-1, "small write is readable");
+	#if(FIFO_DMA_USE_EVENTS == 1)
+		run_events();
+	#endif
+	check(callbacks == 1, "small write callback");
+	check(fifo_dma_read(&fifo, dst, FIFO_DMA_THRESHOLD-1, NULL) == RES_OK, "small read");
+	check(memcmp(dst, src, FIFO_DMA_THRESHOLD-1) == 0, "small read data");
+
+	// Background write across the wrap point
+	check(fifo_dma_write(&fifo, src, 60, done) == RES_OK, "wrapping write");
+	check(fifo_dma_busy(), "wrapping write is in the background");
+	check(fifo_rdcount(&fifo) == 0, "data is not readable before the transfer completes");
+	check(fifo_dma_write(&fifo, src, 40, done) == RES_BUSY, "second write is busy");
+	check(fifo_dma_read(&fifo, dst, 40, done) == RES_BUSY, "read during a write is busy");
+	check(fifo_dma_write(&fifo, src, FIFO_DMA_THRESHOLD-1, done) == RES_BUSY, "small write during a write is busy");
+	check(fifo_dma_read(&fifo, dst, FIFO_DMA_THRESHOLD-1, done) == RES_BUSY, "small read during a write is busy");
+	wait_done(2);
+	check(fifo_rdcount(&fifo) == 60, "wrapping write is readable");
+	memset(dst, 0, sizeof(dst));
+	fifo_read(&fifo, dst, 60);
+	check(memcmp(dst, src, 60) == 0, "wrapping write data");
+
+	// Background read across the wrap point
+	fifo_write(&fifo, src, 70);
+	memset(dst, 0, sizeof(dst));
+	check(fifo_dma_read(&fifo, dst, 70, done) == RES_OK, "wrapping read");
+	check(fifo_dma_busy(), "wrapping read is in the background");
+	check(fifo_dma_read(&fifo, dst, FIFO_DMA_THRESHOLD-1, done) == RES_BUSY, "small read during a read is busy");
+	check(fifo_dma_write(&fifo, src, FIFO_DMA_THRESHOLD-1, done) == RES_BUSY, "small write during a read is busy");
+	wait_done(3);
+	check(fifo_rdcount(&fifo) == 0, "wrapping read consumed the data");
+	check(memcmp(dst, src, 70) == 0, "wrapping read data");
+
+	// Size checks
+	check(fifo_dma_write(&fifo, src, sizeof(fifo_buf), done) == RES_FULL, "write larger than the FIFO");
+	check(fifo_dma_read(&fifo, dst, 40, done) == RES_PARAMERR, "read more than is stored");
+	check(!fifo_dma_busy(), "failed transfers don't start");
+	check(callbacks == 3, "failed transfers have no callback");
+
+	printf("fifo_dma (FIFO_DMA_USE_EVENTS=%d): %lu errors\n", FIFO_DMA_USE_EVENTS, errors);
+
+	if(errors){
+		return(1);
+	}
+	return(0);
+}
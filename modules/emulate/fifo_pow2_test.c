@@ -0,0 +1,168 @@
+
+// Checks FIFO_DECLARE() against the generic FIFO_t.
+// Both FIFOs get the same capacity and the same random sequence of operations. Every operation
+// must return the same result, produce the same data and leave the same byte counts. Transfers are
+// long enough that the indexes wrap many times and that both FIFOs are regularly full and empty.
+// push16()/pop16() are compared against 2-byte little-endian writes and reads.
+//
+// Build:
+//   gcc -std=gnu99 -O2 -Wall -I. -I.. -idirafter ../../include fifo_pow2_test.c fifo.c -o fifo_pow2_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <fifo.h>
+#include <fifo_pow2.h>
+
+#define FIFO_SIZE	64
+#define TEST_OPS	2000000UL
+
+FIFO_DECLARE(Pow2FIFO, FIFO_SIZE)
+
+// FIFO_t always leaves one byte empty
+uint8_t ref_buf[FIFO_SIZE+1];
+FIFO_t ref;
+
+unsigned long errors;
+unsigned long full_count;
+unsigned long empty_count;
+
+//--------------------------------------------------------------------------------------------------
+static void check(int ok, const char *what, unsigned long op){
+	if(!ok){
+		if(errors < 10){
+			printf("Mismatch in %s at operation %lu\n", what, op);
+		}
+		errors++;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(void){
+	uint8_t src[FIFO_SIZE+8];
+	uint8_t dst_p[FIFO_SIZE+8], dst_r[FIFO_SIZE+8];
+	struct fifo_iov iov[2];
+	uint8_t seq = 0;
+	unsigned long op;
+	RES_t res_p, res_r;
+	size_t n, i;
+	uint16_t w_p = 0, w_r;
+	uint8_t b;
+
+	srand(1);
+	Pow2FIFO_init();
+	fifo_init(&ref, ref_buf, sizeof(ref_buf));
+
+	// Directed checks: empty, then filled exactly to capacity
+	check(Pow2FIFO_pop(&b) == RES_PARAMERR, "pop when empty", 0);
+	check(Pow2FIFO_pop16(&w_p) == RES_PARAMERR, "pop16 when empty", 0);
+	for(i=0; i<FIFO_SIZE; i++){
+		check(Pow2FIFO_push(i) == RES_OK, "push to capacity", 0);
+	}
+	check(Pow2FIFO_push(0) == RES_FULL, "push when full", 0);
+	check(Pow2FIFO_wrcount() == 0, "wrcount when full", 0);
+	Pow2FIFO_clear();
+	check(Pow2FIFO_rdcount() == 0, "rdcount after clear", 0);
+
+	for(op=0; op<TEST_OPS; op++){
+		n = rand() % (FIFO_SIZE/2 + 4);
+		for(i=0; i<n; i++){
+			src[i] = seq + i;
+		}
+
+		switch(rand() % 9){
+			case 0: // write
+			case 1:
+				res_p = Pow2FIFO_write(src, n);
+				res_r = fifo_write(&ref, src, n);
+				check(res_p == res_r, "write", op);
+				if(res_r == RES_OK) seq += n;
+				if(res_r == RES_FULL) full_count++;
+				break;
+			case 2: // writev
+				iov[0].buf = src;
+				iov[0].len = n/2;
+				iov[1].buf = src + n/2;
+				iov[1].len = n - n/2;
+				res_p = Pow2FIFO_writev(iov, 2);
+				res_r = fifo_writev(&ref, iov, 2);
+				check(res_p == res_r, "writev", op);
+				if(res_r == RES_OK) seq += n;
+				break;
+			case 3: // read
+			case 4:
+				res_p = Pow2FIFO_read(dst_p, n);
+				res_r = fifo_read(&ref, dst_r, n);
+				check(res_p == res_r, "read", op);
+				if(res_r == RES_OK){
+					check(memcmp(dst_p, dst_r, n) == 0, "read data", op);
+				}else{
+					empty_count++;
+				}
+				break;
+			case 5: // peek
+				res_p = Pow2FIFO_peek(dst_p, n);
+				res_r = fifo_peek(&ref, dst_r, n);
+				check(res_p == res_r, "peek", op);
+				if(res_r == RES_OK){
+					check(memcmp(dst_p, dst_r, n) == 0, "peek data", op);
+				}
+				break;
+			case 6: // single bytes
+				if(rand() & 1){
+					res_p = Pow2FIFO_push(seq);
+					res_r = fifo_write(&ref, &seq, 1);
+					check(res_p == res_r, "push", op);
+					if(res_r == RES_OK) seq++;
+				}else{
+					res_p = Pow2FIFO_pop(&dst_p[0]);
+					res_r = fifo_read(&ref, &dst_r[0], 1);
+					check(res_p == res_r, "pop", op);
+					if(res_r == RES_OK){
+						check(dst_p[0] == dst_r[0], "pop data", op);
+					}
+				}
+				break;
+			case 7: // words
+				if(rand() & 1){
+					w_p = seq | ((uint16_t)(uint8_t)(seq + 1) << 8);
+					src[0] = seq;
+					src[1] = seq + 1;
+					res_p = Pow2FIFO_push16(w_p);
+					res_r = fifo_write(&ref, src, 2);
+					check(res_p == res_r, "push16", op);
+					if(res_r == RES_OK) seq += 2;
+				}else{
+					res_p = Pow2FIFO_pop16(&w_p);
+					res_r = fifo_read(&ref, dst_r, 2);
+					check(res_p == res_r, "pop16", op);
+					if(res_r == RES_OK){
+						w_r = dst_r[0] | ((uint16_t)dst_r[1] << 8);
+						check(w_p == w_r, "pop16 data", op);
+					}
+				}
+				break;
+			case 8: // occasionally start over
+				if((rand() % 64) == 0){
+					Pow2FIFO_clear();
+					fifo_clear(&ref);
+				}
+				break;
+		}
+
+		check(Pow2FIFO_rdcount() == fifo_rdcount(&ref), "rdcount", op);
+		check(Pow2FIFO_wrcount() == fifo_wrcount(&ref), "wrcount", op);
+	}
+
+	fifo_uninit(&ref);
+
+	printf("%lu operations, %lu full, %lu empty, %lu errors\n",
+			TEST_OPS, full_count, empty_count, errors);
+
+	if(errors || !full_count || !empty_count){
+		return(1);
+	}
+	return(0);
+}
@@ -0,0 +1,113 @@
+
+// Stress test for the lock-free SPSC FIFO functions.
+// One thread pushes a running byte sequence in variable sized chunks while another pops it in
+// different sized chunks and checks that nothing was lost, duplicated or reordered.
+//
+// It is built twice. fifo_spsc_test runs the target code in ../fifo.c, with target_shim standing in
+// for the MSP430 headers. The x86 keeps stores in order with other stores and loads in order with
+// other loads, so the compiler barrier and volatile index accesses that the target relies on are
+// what orders the two threads here too. fifo_spsc_test_emu runs the emulated FIFO in fifo.c.
+//
+// Build:
+//   gcc -std=gnu99 -O2 -pthread -I target_shim -I .. -I. -idirafter ../../include fifo_spsc_test.c ../fifo.c -o fifo_spsc_test
+//   gcc -std=gnu99 -O2 -pthread -I. -idirafter ../../include fifo_spsc_test.c fifo.c -o fifo_spsc_test_emu
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <fifo.h>
+
+#define TEST_BYTES	50000000UL
+
+// Odd size so that chunks straddle the wrap point at every possible offset
+uint8_t fifo_buf[61];
+FIFO_t fifo;
+
+//--------------------------------------------------------------------------------------------------
+void *producer(void *arg){
+	uint8_t chunk[17];
+	uint8_t seq = 0;
+	unsigned long sent = 0;
+	size_t size = 1;
+	size_t i;
+
+	while(sent < TEST_BYTES){
+		for(i=0;i<size;i++){
+			chunk[i] = seq + i;
+		}
+
+		if(fifo_spsc_write(&fifo, chunk, size) == RES_OK){
+			seq += size;
+			sent += size;
+			size = (size % sizeof(chunk)) + 1;
+			if(size > (TEST_BYTES - sent)){
+				size = TEST_BYTES - sent;
+			}
+		}else{
+			sched_yield();
+		}
+	}
+	return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+void *consumer(void *arg){
+	uint8_t chunk[23];
+	uint8_t seq = 0;
+	unsigned long received = 0;
+	unsigned long errors = 0;
+	size_t size = 1;
+	size_t i;
+
+	while(received < TEST_BYTES){
+		if(fifo_spsc_rdcount(&fifo) > sizeof(fifo_buf)){
+			errors++;
+		}
+
+		if(fifo_spsc_read(&fifo, chunk, size) == RES_OK){
+			for(i=0;i<size;i++){
+				if(chunk[i] != (uint8_t)(seq + i)){
+					errors++;
+				}
+			}
+			seq += size;
+			received += size;
+			size = (size % sizeof(chunk)) + 1;
+			if(size > (TEST_BYTES - received)){
+				size = TEST_BYTES - received;
+			}
+		}else{
+			sched_yield();
+		}
+	}
+
+	*(unsigned long *)arg = errors;
+	return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+int main(void){
+	pthread_t prod_thread, cons_thread;
+	unsigned long errors;
+
+	fifo_init(&fifo, fifo_buf, sizeof(fifo_buf));
+
+	pthread_create(&cons_thread, NULL, consumer, &errors);
+	pthread_create(&prod_thread, NULL, producer, NULL);
+
+	pthread_join(prod_thread, NULL);
+	pthread_join(cons_thread, NULL);
+
+	if(fifo_spsc_rdcount(&fifo) != 0){
+		errors++;
+	}
+
+	printf("%lu bytes transferred, %lu errors\n", TEST_BYTES, errors);
+
+	if(errors){
+		return(1);
+	}
+	return(0);
+}
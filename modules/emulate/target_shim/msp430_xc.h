@@ -0,0 +1,29 @@
+// Host stand-in for msp430_xc.h so that target modules can be built into the host tests.
+// The host has no interrupts to mask and no low-power modes, so the intrinsics do nothing.
+
+#ifndef MSP430_XC_H
+#define MSP430_XC_H
+
+#include <stdint.h>
+
+#define GIE         0x0008
+#define CPUOFF      0x0010
+#define OSCOFF      0x0020
+#define SCG0        0x0040
+#define SCG1        0x0080
+
+#define LPM0_bits   (CPUOFF)
+#define LPM1_bits   (SCG0+CPUOFF)
+#define LPM2_bits   (SCG1+CPUOFF)
+#define LPM3_bits   (SCG1+SCG0+CPUOFF)
+#define LPM4_bits   (SCG1+SCG0+OSCOFF+CPUOFF)
+
+#define __disable_interrupt()           do{}while(0)
+#define __enable_interrupt()            do{}while(0)
+#define __no_operation()                do{}while(0)
+#define __get_SR_register()             ((uint16_t)GIE)
+#define __bis_SR_register(x)            do{ (void)(x); }while(0)
+#define __bic_SR_register(x)            do{ (void)(x); }while(0)
+#define __bic_SR_register_on_exit(x)    do{ (void)(x); }while(0)
+
+#endif
@@ -0,0 +1,30 @@
+
+// Event queue configuration used by the event queue host tests
+// EVENT_COTHREADS and EVENT_IDLE_SLEEP are set on the command line by the Makefile.
+
+#ifndef EVENT_QUEUE_CONFIG_H
+#define EVENT_QUEUE_CONFIG_H
+
+#define EVENT_QUEUE_SIZE	256
+#define EVENT_QUEUE_PRIO_LEVELS	1
+#define EVENT_PRIO_DEFAULT	0
+#define EVENT_QUEUE_POW2	0
+#define EVENT_QUEUE_RESERVE	0
+#define EVENT_OVF_SOURCES	0
+#define EVENT_UNIQUE_SLOTS	8
+#define MAX_YIELD_DEPTH	2
+#define EVENT_QUEUE_STATS	0
+#define EVENT_QUEUE_TRACE	0
+
+#ifndef EVENT_COTHREADS
+	#define EVENT_COTHREADS	0
+#endif
+
+// Native emulated cothreads run on the pooled stacks, so they need room for host calls
+#define EVENT_COTHREAD_STACK_SIZE	16384
+
+#ifndef EVENT_IDLE_SLEEP
+	#define EVENT_IDLE_SLEEP	0
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+// FIFO DMA configuration used by fifo_dma_test.c
+// FIFO_DMA_USE_EVENTS is set on the command line by the Makefile to test both callback modes.
+
+#ifndef FIFO_DMA_CONFIG_H
+#define FIFO_DMA_CONFIG_H
+
+#define FIFO_DMA_THRESHOLD	32
+
+#ifndef FIFO_DMA_USE_EVENTS
+	#define FIFO_DMA_USE_EVENTS	0
+#endif
+
+// Long enough for the test to see the transfer in progress
+#define FIFO_DMA_EMU_DELAY_US	20000
+
+#endif
@@ -56,7 +56,7 @@ void timer_uninit(void){
 }
 
 //--------------------------------------------------------------------------------------------------
-void timer_start(emu_timer_t *timerid, struct timerctl *settings){
+RES_t timer_start(emu_timer_t *timerid, struct timerctl *settings){
     
     if(timerid->posix_timer_valid){
         // If the timer is already running, stop it. (and delete it)
@@ -65,6 +65,7 @@ void timer_start(emu_timer_t *timerid, struct timerctl *settings){
     
     if(settings){
         // Starting a timer with new settings
+        if(settings->interval_ms == 0) return(RES_PARAMERR);
         
         // Apply the settings to the timerid struct
         timerid->fptr = settings->fptr;
@@ -86,7 +87,7 @@ void timer_start(emu_timer_t *timerid, struct timerctl *settings){
     // don't start the timer if all time values are 0
     if((timerid->its.it_value.tv_sec == 0) && (timerid->its.it_value.tv_nsec == 0) &&
                 (timerid->its.it_interval.tv_sec == 0) && (timerid->its.it_interval.tv_nsec == 0)){
-        return;
+        return(RES_OK);
     }
     
     
@@ -106,6 +107,7 @@ void timer_start(emu_timer_t *timerid, struct timerctl *settings){
     // Start the timer
     timer_settime(timerid->posix_timer, 0, &timerid->its, NULL);
     
+    return(RES_OK);
 }
 
 //--------------------------------------------------------------------------------------------------
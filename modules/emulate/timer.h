@@ -48,6 +48,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <result.h>
 
 #include <time.h> // POSIX timers
 
@@ -107,7 +108,7 @@ void timer_uninit(void);
  * \param settings Pointer to a \ref timerctl struct which defines the behavior of a new timer.
  *     A NULL pointer will resume a previously stopped timer defined by \c timerid
  **/
-void timer_start(emu_timer_t *timerid, struct timerctl *settings);
+RES_t timer_start(emu_timer_t *timerid, struct timerctl *settings);
 
 /**
  * \brief Stops a currently running timer
@@ -48,46 +48,758 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+
+#include <atomic.h>
 
-#include "fifo.h"
 #include "event_queue.h"
 #include <event_queue_config.h>
 
+#if(EVENT_QUEUE_POW2 == 1)
+    #include "fifo_pow2.h"
+#else
+    #include <fifo.h> // Resolved through the include path so host builds pick up emulate/fifo.h
+#endif
+
 //==================================================================================================
 // Internal Variables
 //==================================================================================================
 
-static uint8_t EventQueueBuffer[EVENT_QUEUE_SIZE]; // Allocated array for event queue buffer
-static FIFO_t EventFIFO; // FIFO object for event queue
+#ifndef EVENT_QUEUE_PRIO_LEVELS
+    #define EVENT_QUEUE_PRIO_LEVELS 1
+#endif
+
+#ifndef EVENT_PRIO_DEFAULT
+    #define EVENT_PRIO_DEFAULT      0
+#endif
+
+#if(EVENT_QUEUE_PRIO_LEVELS < 1) || (EVENT_QUEUE_PRIO_LEVELS > 8)
+    #error "EVENT_QUEUE_PRIO_LEVELS must be between 1 and 8"
+#endif
+
+#if(EVENT_PRIO_DEFAULT >= EVENT_QUEUE_PRIO_LEVELS)
+    #error "EVENT_PRIO_DEFAULT must be less than EVENT_QUEUE_PRIO_LEVELS"
+#endif
+
+#ifndef EVENT_QUEUE_STATS
+    #define EVENT_QUEUE_STATS       0
+#endif
+
+#ifndef EVENT_STATS_SLOTS
+    #define EVENT_STATS_SLOTS       8
+#endif
+
+#if(EVENT_QUEUE_STATS == 1) && (EVENT_STATS_SLOTS < 1)
+    #error "EVENT_STATS_SLOTS must be at least 1"
+#endif
+
+#ifndef EVENT_QUEUE_TRACE
+    #define EVENT_QUEUE_TRACE       0
+#endif
+
+#ifndef EVENT_TRACE_RECORDS
+    #define EVENT_TRACE_RECORDS     64
+#endif
+
+#if(EVENT_QUEUE_TRACE == 1) && ((EVENT_TRACE_RECORDS < 1) || (EVENT_TRACE_RECORDS > 0xFFFF))
+    #error "EVENT_TRACE_RECORDS must be between 1 and 65535"
+#endif
+
+#ifndef EVENT_QUEUE_RESERVE
+    #define EVENT_QUEUE_RESERVE     0
+#endif
+
+#ifndef EVENT_OVF_SOURCES
+    #define EVENT_OVF_SOURCES       0
+#endif
+
+#ifndef EVENT_OVF_DATA_MAX
+    #define EVENT_OVF_DATA_MAX      4
+#endif
+
+#if(EVENT_QUEUE_RESERVE >= EVENT_QUEUE_SIZE)
+    #error "EVENT_QUEUE_RESERVE must be smaller than EVENT_QUEUE_SIZE"
+#endif
+
+#ifndef EVENT_UNIQUE_SLOTS
+    #define EVENT_UNIQUE_SLOTS      0
+#endif
+
+#if(EVENT_UNIQUE_SLOTS & (EVENT_UNIQUE_SLOTS - 1)) || (EVENT_UNIQUE_SLOTS > 64)
+    #error "EVENT_UNIQUE_SLOTS must be 0 or a power of two up to 64"
+#endif
+
+#ifndef EVENT_IDLE_SLEEP
+    #define EVENT_IDLE_SLEEP        0
+#endif
+
+#ifndef EVENT_IDLE_LPM_BITS
+    #define EVENT_IDLE_LPM_BITS     LPM0_bits
+#endif
+
+#if(EVENT_IDLE_SLEEP == 1)
+    #include <msp430_xc.h>
+    #define IdleEvent   IdleSleep
+#elif(EVENT_IDLE_SLEEP == 2)
+    #include <event_wait.h>
+    #define IdleEvent   IdleWait
+#else
+    #define IdleEvent   onIdle
+#endif
+
+#ifndef EVENT_COTHREADS
+    #define EVENT_COTHREADS         0
+#endif
+
+#ifndef EVENT_COTHREAD_STACK_SIZE
+    #define EVENT_COTHREAD_STACK_SIZE   256
+#endif
+
+#ifndef EVENT_THREAD_HANDLERS
+    #define EVENT_THREAD_HANDLERS   4
+#endif
+
+#if(EVENT_COTHREADS > 0)
+    #include <msp430_xc.h>
+    #include <cothread.h>
+#endif
+
+// Each priority level has its own queue. The EventFIFO_* macros take the level as their first
+// argument. The FIFO_DECLARE() FIFO only supports a single level.
+#if(EVENT_QUEUE_POW2 == 1)
+    #if(EVENT_QUEUE_PRIO_LEVELS > 1)
+        #error "EVENT_QUEUE_POW2 only supports EVENT_QUEUE_PRIO_LEVELS = 1"
+    #endif
+    
+    FIFO_DECLARE(EventFIFO, EVENT_QUEUE_SIZE) // FIFO object for event queue
+    
+    #define EventFIFO_initall()         EventFIFO_init()
+    #define EventFIFO_writev(p,iov,n)   EventFIFO_writev(iov,n)
+    #define EventFIFO_read(p,dst,n)     EventFIFO_read(dst,n)
+    #define EventFIFO_peek(p,dst,n)     EventFIFO_peek(dst,n)
+    #define EventFIFO_rdcount(p)        EventFIFO_rdcount()
+    #define EventFIFO_wrcount(p)        EventFIFO_wrcount()
+#else
+    // Allocated arrays for the event queue buffers
+    static uint8_t EventQueueBuffer[EVENT_QUEUE_PRIO_LEVELS][EVENT_QUEUE_SIZE];
+    static FIFO_t EventFIFO[EVENT_QUEUE_PRIO_LEVELS]; // FIFO objects for the event queue
+    
+    #if(EVENT_QUEUE_PRIO_LEVELS == 1)
+        static const char * const EventFIFOName[] = {"event_queue"};
+    #else
+        static const char * const EventFIFOName[] = {
+            "event_queue0", "event_queue1", "event_queue2", "event_queue3",
+            "event_queue4", "event_queue5", "event_queue6", "event_queue7"
+        };
+    #endif
+    
+    static void EventFIFO_initall(void){
+        uint8_t p;
+        for(p=0; p<EVENT_QUEUE_PRIO_LEVELS; p++){
+            fifo_init(&EventFIFO[p],EventQueueBuffer[p],EVENT_QUEUE_SIZE);
+            fifo_register(&EventFIFO[p],EventFIFOName[p]);
+        }
+    }
+    #define EventFIFO_writev(p,iov,n)   fifo_writev(&EventFIFO[p],iov,n)
+    #define EventFIFO_read(p,dst,n)     fifo_read(&EventFIFO[p],dst,n)
+    #define EventFIFO_peek(p,dst,n)     fifo_peek(&EventFIFO[p],dst,n)
+    #define EventFIFO_rdcount(p)        fifo_rdcount(&EventFIFO[p])
+    #define EventFIFO_wrcount(p)        fifo_wrcount(&EventFIFO[p])
+#endif
 
 static uint8_t YieldDepth;
 static void (*YieldedEvents[MAX_YIELD_DEPTH+1])(void);
 
+// Priority level of the event that is currently running. event_PopEventData() reads from this level.
+static uint8_t CurrentPrio;
+
+#if(EVENT_QUEUE_STATS == 1)
+    static event_stats_t EventStats[EVENT_STATS_SLOTS];
+#endif
+
+#if(EVENT_QUEUE_TRACE == 1)
+    static event_trace_rec_t TraceBuf[EVENT_TRACE_RECORDS];
+    static uint16_t TraceHead;  // Next record to write
+    static uint16_t TraceCount; // Number of valid records
+    static bool TraceOn;
+    static void (*TraceIdleFn)(void); // Idle process whose IDLE record has no END yet
+    
+    #define TRACE(type, fptr, size)                 TraceRecord(type, fptr, size, 0)
+    #define TRACE_DISPATCH(fptr, size, queued)      TraceRecord(EVENT_TRACE_DISPATCH, fptr, size, queued)
+    #define TRACE_IDLE(fptr)                        TraceIdle(fptr)
+    #define TRACE_BUSY()                            TraceBusy()
+#else
+    #define TRACE(type, fptr, size)
+    #define TRACE_DISPATCH(fptr, size, queued)
+    #define TRACE_IDLE(fptr)
+    #define TRACE_BUSY()
+#endif
+
+// Overflow policy of an event source (handler)
+typedef struct{
+    void (*fptr)(void);     // NULL if the slot is unused
+    void (*onFull)(void);   // Backpressure callback. May be NULL.
+    uint16_t lost;
+    uint8_t policy;
+    
+    // EVENT_OVF_KEEP_LATEST: newest event that did not fit in the queue
+    bool deferred;
+    uint8_t deferred_prio;
+    uint8_t deferred_size;
+    uint8_t deferred_data[EVENT_OVF_DATA_MAX];
+} ovf_source_t;
+
+#if(EVENT_OVF_SOURCES > 0)
+    static ovf_source_t OvfSources[EVENT_OVF_SOURCES];
+    static bool DeferredPending; // At least one source has a deferred event
+#endif
+
+// Events lost from sources without an overflow policy
+static uint16_t LostCount;
+
+#if(EVENT_IDLE_SLEEP == 2)
+    static uint32_t IdleWakeups;    // event_emu_wakeups() when onIdle() was last called
+    static bool IdleCalled;         // onIdle() was called since event_init()
+#endif
+
+#if(EVENT_COTHREADS > 0)
+    // Pooled thread that runs a handler registered with event_SetThreaded()
+    typedef struct{
+        cothread_t thread;
+        void (*handler)(void);  // NULL if the thread is free
+        uint8_t prio;           // Priority level it was dispatched from. It is resumed from the same.
+        uint8_t seq;            // Incremented every time the thread yields
+        bool suspended;         // Yielded and waiting for its ThreadResume event
+        uint8_t stack[EVENT_COTHREAD_STACK_SIZE] __attribute__ ((aligned (__BIGGEST_ALIGNMENT__)));
+    } ev_thread_t;
+    
+    // Data of a ThreadResume event. It is stale if the thread was resumed some other way since.
+    typedef struct{
+        ev_thread_t *t;
+        uint8_t seq;
+    } ev_resume_t;
+    
+    static ev_thread_t EvThreads[EVENT_COTHREADS];
+    static cothread_t HomeThread;           // Thread that runs the event handler loop
+    static ev_thread_t *ActiveThread;       // Pooled thread that is running. NULL in HomeThread.
+    static void (*ThreadedHandlers[EVENT_THREAD_HANDLERS])(void);
+#endif
+
+#if(EVENT_UNIQUE_SLOTS > 0)
+    // Hash set of the handlers that were pushed by event_PushEventUnique() and are still pending.
+    // Open addressing with linear probing. Empty entries are NULL.
+    static void (*UniquePending[EVENT_UNIQUE_SLOTS])(void);
+    static uint8_t UniqueCount; // Number of handlers in UniquePending
+#endif
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// Returns the highest priority level that has an event pending. -1 if all levels are empty.
+static int8_t NextPrio(void){
+    int8_t p;
+    
+    for(p=EVENT_QUEUE_PRIO_LEVELS-1; p>=0; p--){
+        if(EventFIFO_rdcount(p)){
+            return(p);
+        }
+    }
+    return(-1);
+}
+
+#if(EVENT_QUEUE_STATS == 1)
+//--------------------------------------------------------------------------------------------------
+// Returns the histogram bin for a time: 0 for 0, otherwise floor(log2(t))+1
+static uint8_t StatsBin(uint16_t t){
+    uint8_t bin = 0;
+    
+    while(t){
+        t >>= 1;
+        bin++;
+    }
+    return(bin);
+}
+
+//--------------------------------------------------------------------------------------------------
+static void StatsAdd(event_timing_t *timing, uint16_t t, bool first){
+    uint8_t bin;
+    
+    if(first || (t < timing->min)) timing->min = t;
+    if(first || (t > timing->max)) timing->max = t;
+    timing->sum += t;
+    
+    bin = StatsBin(t);
+    if(timing->hist[bin] != UINT16_MAX){
+        timing->hist[bin]++;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Adds one dispatch of an event handler to its statistics slot. Handlers that do not fit in the
+// table are all counted in the last slot, which then has a NULL fptr.
+static void StatsRecord(void (*fptr)(void), uint16_t latency, uint16_t runtime){
+    event_stats_t *slot;
+    uint8_t i;
+    
+    for(i=0; i<EVENT_STATS_SLOTS-1; i++){
+        if((EventStats[i].fptr == fptr) || (EventStats[i].count == 0)){
+            break;
+        }
+    }
+    slot = &EventStats[i];
+    
+    if(slot->count == 0){
+        slot->fptr = fptr;
+    }else if(slot->fptr != fptr){
+        slot->fptr = NULL;
+    }
+    
+    StatsAdd(&slot->latency, latency, (slot->count == 0));
+    StatsAdd(&slot->runtime, runtime, (slot->count == 0));
+    slot->count++;
+}
+#endif
+
+#if(EVENT_IDLE_SLEEP == 1)
+//--------------------------------------------------------------------------------------------------
+// Built-in idle event. Sleeps until an ISR wakes the CPU with EVENT_WAKE_ON_EXIT().
+static void IdleSleep(void){
+    __disable_interrupt();
+    __no_operation();
+    
+    if(NextPrio() < 0){
+        // Setting GIE and the LPM bits in one instruction closes the window where an ISR could push
+        // an event between the check above and going to sleep.
+        __bis_SR_register(EVENT_IDLE_LPM_BITS | GIE);
+        __no_operation();
+    }
+    
+    __enable_interrupt();
+}
+#endif
+
+#if(EVENT_IDLE_SLEEP == 2)
+//--------------------------------------------------------------------------------------------------
+// Built-in idle event for host builds. Calls onIdle() once each time the queue becomes empty, then
+// blocks the thread until the next push.
+static void IdleWait(void){
+    uint32_t wakeups;
+    
+    // Sampled before the queue is checked so that a push in between is never missed
+    wakeups = event_emu_wakeups();
+    if(NextPrio() >= 0){
+        return;
+    }
+    
+    if(!IdleCalled || (wakeups != IdleWakeups)){
+        // Something was pushed since the last onIdle(), so this is a new idle period
+        IdleCalled = true;
+        IdleWakeups = wakeups;
+        onIdle();
+        return;
+    }
+    
+    event_emu_wait(wakeups);
+}
+#endif
+
+#if(EVENT_QUEUE_TRACE == 1)
+//--------------------------------------------------------------------------------------------------
+// Adds a record to the trace ring buffer. Once it is full, the oldest record is overwritten.
+static void TraceRecord(uint8_t type, void (*fptr)(void), size_t size, size_t queued){
+    event_trace_rec_t *rec;
+    
+    if(!TraceOn){
+        return;
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        rec = &TraceBuf[TraceHead];
+        rec->time = event_stats_time();
+        rec->type = type;
+        rec->size = (size > 0xFF) ? 0xFF : size;
+        rec->queued = (queued > 0xFFFF) ? 0xFFFF : queued;
+        rec->fptr = (uintptr_t)fptr;
+        
+        TraceHead++;
+        if(TraceHead == EVENT_TRACE_RECORDS){
+            TraceHead = 0;
+        }
+        if(TraceCount < EVENT_TRACE_RECORDS){
+            TraceCount++;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Records that the queue went idle. The idle process is called over and over while nothing is
+// pending, so only the first call is recorded. Otherwise the idle records would quickly push all
+// useful history out of the buffer.
+static void TraceIdle(void (*fptr)(void)){
+    if(TraceIdleFn == NULL){
+        TraceIdleFn = fptr;
+        TraceRecord(EVENT_TRACE_IDLE, fptr, 0, 0);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Records the end of the idle period, if there is one
+static void TraceBusy(void){
+    if(TraceIdleFn){
+        TraceRecord(EVENT_TRACE_END, TraceIdleFn, 0, 0);
+        TraceIdleFn = NULL;
+    }
+}
+#endif
+
+#if(EVENT_UNIQUE_SLOTS > 0)
+//--------------------------------------------------------------------------------------------------
+// Home slot of a handler in UniquePending. Function addresses are word aligned, so bit 0 is dropped.
+static uint8_t UniqueHash(void (*fptr)(void)){
+    uintptr_t p = (uintptr_t)fptr;
+    return(((p >> 1) ^ (p >> 5)) & (EVENT_UNIQUE_SLOTS - 1));
+}
+
+//--------------------------------------------------------------------------------------------------
+// Returns the index of fptr in UniquePending, or of the empty entry where it would go.
+// Returns -1 if it is not there and the set is full. Must be called with interrupts disabled.
+static int8_t UniqueFind(void (*fptr)(void)){
+    uint8_t i = UniqueHash(fptr);
+    uint8_t n;
+    
+    for(n=0; n<EVENT_UNIQUE_SLOTS; n++){
+        if((UniquePending[i] == fptr) || (UniquePending[i] == NULL)){
+            return(i);
+        }
+        i = (i + 1) & (EVENT_UNIQUE_SLOTS - 1);
+    }
+    return(-1);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Removes fptr from UniquePending if it is there
+static void UniqueRemove(void (*fptr)(void)){
+    int8_t hole;
+    uint8_t i;
+    uint8_t home;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        hole = UniqueFind(fptr);
+        if((hole >= 0) && (UniquePending[hole] == fptr)){
+            UniquePending[hole] = NULL;
+            UniqueCount--;
+            
+            // Shift back any following entries that can no longer be reached from their home slot
+            i = hole;
+            while(1){
+                i = (i + 1) & (EVENT_UNIQUE_SLOTS - 1);
+                if(UniquePending[i] == NULL) break;
+                
+                home = UniqueHash(UniquePending[i]);
+                if(((i - home) & (EVENT_UNIQUE_SLOTS - 1)) >= ((i - hole) & (EVENT_UNIQUE_SLOTS - 1))){
+                    UniquePending[hole] = UniquePending[i];
+                    UniquePending[i] = NULL;
+                    hole = i;
+                }
+            }
+        }
+    }
+}
+#endif
+
+#if(EVENT_COTHREADS > 0)
+//--------------------------------------------------------------------------------------------------
+static bool IsThreaded(void (*fptr)(void)){
+    uint8_t i;
+    
+    for(i=0; i<EVENT_THREAD_HANDLERS; i++){
+        if(ThreadedHandlers[i] == fptr){
+            return(true);
+        }
+    }
+    return(false);
+}
+
+//--------------------------------------------------------------------------------------------------
+static int ThreadEntry(void){
+    // cothread_create() starts threads with interrupts disabled
+    __enable_interrupt();
+    
+    ActiveThread->handler();
+    
+    // Non-zero exit value tells ThreadSwitch() that the handler is done
+    return(1);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Runs a pooled thread until its handler yields or returns
+static void ThreadSwitch(ev_thread_t *t){
+    t->suspended = false;
+    ActiveThread = t;
+    if(cothread_switch(&t->thread) != 0){
+        // Thread exited. It is free again.
+        t->handler = NULL;
+    }
+    ActiveThread = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Internal event that resumes a thread that yielded
+static void ThreadResume(void){
+    ev_resume_t r;
+    
+    event_PopEventData(&r, sizeof(r));
+    if(r.t->suspended && (r.t->seq == r.seq)){
+        ThreadSwitch(r.t);
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------
+// Calls a handler. Registered handlers are started in a pooled thread if one is free.
+static void RunHandler(void (*EventProcess)(void)){
+#if(EVENT_COTHREADS > 0)
+    ev_thread_t *t;
+    uint8_t i;
+    
+    if(IsThreaded(EventProcess)){
+        // A threaded handler never runs twice at once. If an earlier call is suspended, it is run
+        // to the end first. The resume events it leaves in the queue are stale and get ignored.
+        for(i=0; i<EVENT_COTHREADS; i++){
+            t = &EvThreads[i];
+            if(t->handler == EventProcess){
+                while(t->handler == EventProcess){
+                    ThreadSwitch(t);
+                }
+                break;
+            }
+        }
+        
+        for(i=0; i<EVENT_COTHREADS; i++){
+            t = &EvThreads[i];
+            if(t->handler == NULL){
+                t->handler = EventProcess;
+                t->prio = CurrentPrio;
+                t->thread.co_exit = &HomeThread;
+                t->thread.alt_stack = (stack_t*)t->stack;
+                t->thread.alt_stack_size = sizeof(t->stack);
+                cothread_create(&t->thread, ThreadEntry);
+                ThreadSwitch(t);
+                return;
+            }
+        }
+        // No threads are free. Run it on this stack like any other handler.
+    }
+#endif
+    EventProcess();
+}
+
+//--------------------------------------------------------------------------------------------------
+// Calls an event handler whose function pointer was just read out of the CurrentPrio queue
+static void CallEvent(void (*EventProcess)(void)){
+#if(EVENT_QUEUE_STATS == 1)
+    uint16_t pushed;
+    uint16_t start;
+#endif
+#if(EVENT_QUEUE_TRACE == 1)
+    uint8_t size;
+#endif
+    
+#if(EVENT_UNIQUE_SLOTS > 0)
+    // From now on, event_PushEventUnique() queues this handler again.
+    // (Unlocked check: a handler can only be added to the set while it is not being dispatched)
+    if(UniqueCount){
+        UniqueRemove(EventProcess);
+    }
+#endif
+    
+#if(EVENT_QUEUE_STATS == 1)
+    // The push timestamp follows the function pointer
+    EventFIFO_read(CurrentPrio,&pushed,sizeof(pushed));
+#endif
+#if(EVENT_QUEUE_TRACE == 1)
+    // Followed by the size of the event data
+    EventFIFO_read(CurrentPrio,&size,sizeof(size));
+#endif
+    
+    TRACE_BUSY();
+    TRACE_DISPATCH(EventProcess, size, EventFIFO_rdcount(CurrentPrio));
+    
+#if(EVENT_QUEUE_STATS == 1)
+    start = event_stats_time();
+    RunHandler(EventProcess);
+    StatsRecord(EventProcess, start - pushed, event_stats_time() - start);
+#else
+    RunHandler(EventProcess);
+#endif
+    
+    // An idle period that started in event_YieldEvent() ends with the handler
+    TRACE_BUSY();
+    TRACE(EVENT_TRACE_END, EventProcess, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Writes an event into the queue of the given level. Fails if that would leave fewer than
+// reserve bytes free. Must be called with interrupts disabled.
+static RES_t QueueWrite(void (*fptr)(void), void *eventData, size_t size, uint8_t prio,
+                        size_t reserve){
+    struct fifo_iov iov[4];
+#if(EVENT_QUEUE_STATS == 1)
+    uint16_t pushed;
+#endif
+#if(EVENT_QUEUE_TRACE == 1)
+    uint8_t traced_size = (size > 0xFF) ? 0xFF : size;
+#endif
+    uint8_t n = 0;
+    RES_t res = RES_FULL;
+#if(EVENT_QUEUE_RESERVE > 0)
+    size_t total = 0;
+    uint8_t i;
+#endif
+    
+    // The event pointer and its data are written together so that a push from an ISR can never
+    // land between them. If there is not enough room, nothing is written.
+    iov[n].buf = &fptr;
+    iov[n].len = sizeof(fptr);
+    n++;
+#if(EVENT_QUEUE_STATS == 1)
+    pushed = event_stats_time();
+    iov[n].buf = &pushed;
+    iov[n].len = sizeof(pushed);
+    n++;
+#endif
+#if(EVENT_QUEUE_TRACE == 1)
+    // So that the DISPATCH record can show the size too
+    iov[n].buf = &traced_size;
+    iov[n].len = sizeof(traced_size);
+    n++;
+#endif
+    iov[n].buf = eventData;
+    iov[n].len = size;
+    n++;
+    
+#if(EVENT_QUEUE_RESERVE > 0)
+    for(i=0; i<n; i++){
+        total += iov[i].len;
+    }
+    if(EventFIFO_wrcount(prio) >= (total + reserve))
+#endif
+    {
+        res = EventFIFO_writev(prio, iov, n);
+    }
+    
+    TRACE((res == RES_OK) ? EVENT_TRACE_PUSH : EVENT_TRACE_DROP, fptr, size);
+#if(EVENT_IDLE_SLEEP == 2)
+    if(res == RES_OK){
+        event_emu_wake();
+    }
+#endif
+    return(res);
+}
+
+#if(EVENT_OVF_SOURCES > 0)
+//--------------------------------------------------------------------------------------------------
+static ovf_source_t* FindSource(void (*fptr)(void)){
+    uint8_t i;
+    
+    for(i=0; i<EVENT_OVF_SOURCES; i++){
+        if(OvfSources[i].fptr == fptr){
+            return(&OvfSources[i]);
+        }
+    }
+    return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Retries the deferred events of EVENT_OVF_KEEP_LATEST sources
+static void PushDeferred(void){
+    ovf_source_t *src;
+    uint8_t i;
+    
+    DeferredPending = false;
+    
+    for(i=0; i<EVENT_OVF_SOURCES; i++){
+        src = &OvfSources[i];
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(src->deferred){
+                if(QueueWrite(src->fptr, src->deferred_data, src->deferred_size, src->deferred_prio,
+                              EVENT_QUEUE_RESERVE) == RES_OK){
+                    src->deferred = false;
+                }else{
+                    DeferredPending = true;
+                }
+            }
+        }
+    }
+}
+#else
+    #define FindSource(fptr)    NULL
+#endif
+
+//--------------------------------------------------------------------------------------------------
+// Applies the source's overflow policy to an event that did not fit in the queue.
+// Must be called with interrupts disabled.
+static RES_t Overflow(ovf_source_t *src, void *eventData, size_t size, uint8_t prio){
+    if(src == NULL){
+        if(LostCount != UINT16_MAX) LostCount++;
+        return(RES_FULL);
+    }
+    
+    if((src->policy == EVENT_OVF_KEEP_LATEST) && (size <= EVENT_OVF_DATA_MAX)){
+        if(src->deferred){
+            // Replaces the older deferred event
+            if(src->lost != UINT16_MAX) src->lost++;
+        }
+        memcpy(src->deferred_data, eventData, size);
+        src->deferred_size = size;
+        src->deferred_prio = prio;
+        src->deferred = true;
+        #if(EVENT_OVF_SOURCES > 0)
+            DeferredPending = true;
+        #endif
+        return(RES_OK);
+    }
+    
+    if(src->lost != UINT16_MAX) src->lost++;
+    return(RES_FULL);
+}
+
 //==================================================================================================
 // Event Handler Loop Process
 //==================================================================================================
 
 void event_StartHandler(void){
     void (*EventProcess)(void);
+    int8_t prio;
     
     while(1){
-        if(fifo_rdcount(&EventFIFO)){ // If there is an event in the queue
-            // pop the pointer to the event handler out of the queue
-            fifo_read(&EventFIFO,&EventProcess,sizeof(EventProcess)); 
+        #if(EVENT_OVF_SOURCES > 0)
+            if(DeferredPending){
+                PushDeferred();
+            }
+        #endif
+        
+        prio = NextPrio();
+        if(prio >= 0){ // If there is an event in the queue
+            // pop the pointer to the event handler out of the highest priority queue
+            EventFIFO_read(prio,&EventProcess,sizeof(EventProcess)); 
+            CurrentPrio = prio;
             
             // Store which event is going to happen
             YieldedEvents[0] = EventProcess;
             
             // Call the event handler routine. If additional event-related data is stored in the 
             // queue, the event handler MUST pop it out before exiting!
-            EventProcess();
+            CallEvent(EventProcess);
         }else{
             // Only enter the idle process if there are no events pending
             
             // Store which event is going to happen
-            YieldedEvents[0] = onIdle;
+            YieldedEvents[0] = IdleEvent;
             
-            onIdle();    // Idle process event
+            TRACE_IDLE(IdleEvent);
+            IdleEvent();    // Idle process event
         }
     }
 }
@@ -97,31 +809,166 @@ void event_StartHandler(void){
 //==================================================================================================
 
 void event_init(void){
-    fifo_init(&EventFIFO,EventQueueBuffer,EVENT_QUEUE_SIZE);
+    EventFIFO_initall();
+    CurrentPrio = EVENT_PRIO_DEFAULT;
     YieldDepth = 0;
     YieldedEvents[0] = NULL;
+    event_ResetStats();
+    #if(EVENT_UNIQUE_SLOTS > 0)
+        memset(UniquePending, 0, sizeof(UniquePending));
+        UniqueCount = 0;
+    #endif
+    #if(EVENT_QUEUE_TRACE == 1)
+        TraceHead = 0;
+        TraceCount = 0;
+        TraceOn = true;
+        TraceIdleFn = NULL;
+    #endif
+    #if(EVENT_OVF_SOURCES > 0)
+        memset(OvfSources, 0, sizeof(OvfSources));
+        DeferredPending = false;
+    #endif
+    LostCount = 0;
+    #if(EVENT_IDLE_SLEEP == 2)
+        IdleCalled = false;
+    #endif
+    #if(EVENT_COTHREADS > 0)
+        cothread_init(&HomeThread);
+        memset(EvThreads, 0, sizeof(EvThreads));
+        memset(ThreadedHandlers, 0, sizeof(ThreadedHandlers));
+        ActiveThread = NULL;
+    #endif
 }
 
 //--------------------------------------------------------------------------------------------------
 
 RES_t event_PushEvent(void (*fptr)(void), void *eventData, size_t size){
-    if(fifo_wrcount(&EventFIFO) >= (sizeof(fptr)+size)){
-        // Enough room in Event Queue. Write event.
-        fifo_write(&EventFIFO,&fptr,sizeof(fptr));
-        if(size != 0){
-            fifo_write(&EventFIFO,eventData,size);
+    return(event_PushEventPrio(fptr, eventData, size, EVENT_PRIO_DEFAULT));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+RES_t event_PushEventPrio(void (*fptr)(void), void *eventData, size_t size, uint8_t prio){
+    ovf_source_t *src;
+    size_t reserve = EVENT_QUEUE_RESERVE;
+    bool overflow = false;
+    RES_t res = RES_FULL;
+    
+    if(prio >= EVENT_QUEUE_PRIO_LEVELS){
+        return(RES_PARAMERR);
+    }
+    
+    src = FindSource(fptr);
+    if(src && (src->policy == EVENT_OVF_RESERVE)){
+        reserve = 0;
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        // While a source has a deferred event, newer events replace it so that they stay in order
+        if(!(src && src->deferred)){
+            res = QueueWrite(fptr, eventData, size, prio, reserve);
+        }
+        
+        if(res != RES_OK){
+            overflow = true;
+            res = Overflow(src, eventData, size, prio);
+        }
+    }
+    
+    if(overflow && src && src->onFull){
+        src->onFull();
+    }
+    
+    return(res);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+RES_t event_PushEventUnique(void (*fptr)(void), void *eventData, size_t size){
+#if(EVENT_UNIQUE_SLOTS > 0)
+    RES_t res = RES_OK;
+    int8_t i;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        i = UniqueFind(fptr);
+        if(i < 0){
+            res = RES_FULL;
+        }else if(UniquePending[i] == NULL){
+            res = event_PushEvent(fptr, eventData, size);
+            if(res == RES_OK){
+                UniquePending[i] = fptr;
+                UniqueCount++;
+            }
         }
+    }
+    return(res);
+#else
+    return(event_PushEvent(fptr, eventData, size));
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+RES_t event_SetOverflowPolicy(void (*fptr)(void), event_ovf_policy_t policy, void (*onFull)(void)){
+#if(EVENT_OVF_SOURCES > 0)
+    ovf_source_t *src;
+    
+    src = FindSource(fptr);
+    if(src == NULL){
+        src = FindSource(NULL);
+        if(src == NULL){
+            return(RES_FULL);
+        }
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        src->fptr = fptr;
+        src->onFull = onFull;
+        src->policy = policy;
+        src->lost = 0;
+    }
+    return(RES_OK);
+#else
+    return(RES_FULL);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+uint16_t event_GetLostCount(void (*fptr)(void)){
+    ovf_source_t *src;
+    
+    src = FindSource(fptr);
+    if(fptr && src){
+        return(src->lost);
+    }
+    return(LostCount);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+RES_t event_SetThreaded(void (*fptr)(void)){
+#if(EVENT_COTHREADS > 0)
+    uint8_t i;
+    
+    if(IsThreaded(fptr)){
         return(RES_OK);
-    }else{
-        // Not enough room in event queue.
-        return(RES_FULL);
     }
+    
+    for(i=0; i<EVENT_THREAD_HANDLERS; i++){
+        if(ThreadedHandlers[i] == NULL){
+            ThreadedHandlers[i] = fptr;
+            return(RES_OK);
+        }
+    }
+#endif
+    return(RES_FULL);
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void event_PopEventData(void *dst, size_t size){
-    fifo_read(&EventFIFO,dst,size);
+    EventFIFO_read(CurrentPrio,dst,size);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -129,15 +976,37 @@ void event_PopEventData(void *dst, size_t size){
 void event_YieldEvent(void){
     void (*EventProcess)(void);
     uint8_t i,skip;
+    uint8_t prev_prio;
+    int8_t prio;
+    
+#if(EVENT_COTHREADS > 0)
+    ev_resume_t r;
+    
+    if(ActiveThread){
+        // Running in a pooled thread. Queue its resumption behind the events that are already
+        // pending and go back to the event handler loop. If the queue is full, keep running.
+        r.t = ActiveThread;
+        r.seq = ++r.t->seq;
+        TRACE(EVENT_TRACE_YIELD, r.t->handler, 0);
+        if(event_PushEventPrio(ThreadResume, &r, sizeof(r), r.t->prio) == RES_OK){
+            r.t->suspended = true;
+            cothread_switch(&HomeThread);
+        }
+        return;
+    }
+#endif
     
     if(YieldDepth >= MAX_YIELD_DEPTH){
         // hit the max yield depth. Quit
         return;
     }
     
-    if(fifo_rdcount(&EventFIFO)){ // If there is an event in the queue
-        // pop the pointer to the event handler out of the queue
-        fifo_peek(&EventFIFO,&EventProcess,sizeof(EventProcess)); 
+    TRACE(EVENT_TRACE_YIELD, YieldedEvents[YieldDepth], 0);
+    
+    prio = NextPrio();
+    if(prio >= 0){ // If there is an event in the queue
+        // pop the pointer to the event handler out of the highest priority queue
+        EventFIFO_peek(prio,&EventProcess,sizeof(EventProcess)); 
         
         skip = 0;
         for(i=0;i<=YieldDepth;i++){
@@ -152,13 +1021,19 @@ void event_YieldEvent(void){
             // Event is safe to call
             
             // flush the peeked data.
-            fifo_read(&EventFIFO,NULL,sizeof(EventProcess)); 
+            EventFIFO_read(prio,NULL,sizeof(EventProcess)); 
+            
+            // The yielded event's data is read from its own level
+            prev_prio = CurrentPrio;
+            CurrentPrio = prio;
             
             YieldDepth++;
             // Store which event is going to happen
             YieldedEvents[YieldDepth] = EventProcess;
-            EventProcess(); // Call the event process
+            CallEvent(EventProcess); // Call the event process
             YieldDepth--;
+            
+            CurrentPrio = prev_prio;
             return;
         }
     }
@@ -166,6 +1041,9 @@ void event_YieldEvent(void){
     // Either no events pending or the event pending has been yielded already.
     // Lets try the idle process
     
+#if(EVENT_IDLE_SLEEP != 1)
+    // (With the built-in idle, nothing is done. The caller is most likely polling for something that
+    // does not push an event, so sleeping here could wait forever.)
     skip = 0;
     for(i=0;i<=YieldDepth;i++){
         if(onIdle == YieldedEvents[i]){
@@ -177,18 +1055,90 @@ void event_YieldEvent(void){
     YieldDepth++;
     // Store which event is going to happen
     YieldedEvents[YieldDepth] = onIdle;
+    TRACE_IDLE(onIdle);
     onIdle();    // Idle process event
     YieldDepth--;
+#endif
 }
 //--------------------------------------------------------------------------------------------------
 
 bool event_Pending(void){
-    if(fifo_rdcount(&EventFIFO)){
+    if(NextPrio() >= 0){
         return(true);
     }else{
         return(false);
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+
+const event_stats_t* event_GetStats(uint8_t idx){
+#if(EVENT_QUEUE_STATS == 1)
+    if((idx < EVENT_STATS_SLOTS) && (EventStats[idx].count != 0)){
+        return(&EventStats[idx]);
+    }
+#endif
+    return(NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void event_ResetStats(void){
+#if(EVENT_QUEUE_STATS == 1)
+    memset(EventStats, 0, sizeof(EventStats));
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void event_TraceEnable(bool enable){
+#if(EVENT_QUEUE_TRACE == 1)
+    TraceOn = enable;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void event_TraceDump(void (*write)(void *buf, size_t size)){
+#if(EVENT_QUEUE_TRACE == 1)
+    struct{
+        char magic[4];
+        uint8_t version;
+        uint8_t rec_size;
+        uint16_t count;
+    } header;
+    bool was_on;
+    uint16_t idx;
+    uint16_t n;
+    
+    // Stop recording so the buffer doesn't change underneath
+    was_on = TraceOn;
+    TraceOn = false;
+    
+    memcpy(header.magic, "EVTR", 4);
+    header.version = 2;
+    header.rec_size = sizeof(event_trace_rec_t);
+    header.count = TraceCount;
+    write(&header, sizeof(header));
+    
+    // Oldest record first
+    if(TraceCount < EVENT_TRACE_RECORDS){
+        idx = 0;
+    }else{
+        idx = TraceHead;
+    }
+    
+    for(n=0; n<TraceCount; n++){
+        write(&TraceBuf[idx], sizeof(event_trace_rec_t));
+        idx++;
+        if(idx == EVENT_TRACE_RECORDS){
+            idx = 0;
+        }
+    }
+    
+    TraceOn = was_on;
+#endif
+}
+
 //--------------------------------------------------------------------------------------------------
 ///\}
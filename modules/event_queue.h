@@ -67,6 +67,18 @@
 *     }
 * \endcode
 * 
+* Instead of providing onIdle(), the application can set \c EVENT_IDLE_SLEEP to 1 in
+* event_queue_config.h. The event handler then puts the CPU to sleep whenever the queue is empty.
+* Every ISR that pushes an event must end with EVENT_WAKE_ON_EXIT() so that the CPU wakes up to
+* process it:
+* 
+* \code
+*     ISR(TIMER0_A0, timer_isr){
+*         event_PushEvent(onTick, NULL, 0);
+*         EVENT_WAKE_ON_EXIT();
+*     }
+* \endcode
+* 
 * \ref MOD_EVENT_QUEUE also requires the following modules:
 *    - \ref MOD_FIFO
 *
@@ -93,6 +105,79 @@ extern "C" {
 
 #include "event_queue.h"
 
+//==================================================================================================
+// Macros
+//==================================================================================================
+
+/**
+* \brief Wakes the CPU from low-power mode when the ISR exits if an event is pending
+* \details Call at the end of any ISR that pushes events. This is required for the built-in idle
+*   (\c EVENT_IDLE_SLEEP) and for any onIdle() that puts the CPU to sleep.
+* 
+*   It must be called from the ISR function itself and not from a function that the ISR calls.
+* \hideinitializer
+**/
+#define EVENT_WAKE_ON_EXIT() \
+    do{ \
+        if(event_Pending()){ \
+            __bic_SR_register_on_exit(LPM4_bits); \
+            __no_operation(); \
+        } \
+    }while(0)
+
+//==================================================================================================
+// Types
+//==================================================================================================
+
+/// Number of histogram bins in #event_timing_t
+#define EVENT_STATS_HIST_BINS   17
+
+/// Timing statistics for one measurement. All times are in event_stats_time() ticks.
+typedef struct{
+    uint16_t min;   ///< Shortest time seen
+    uint16_t max;   ///< Longest time seen
+    uint32_t sum;   ///< Sum of all times. Divide by event_stats_t::count for the average.
+    
+    /// log2 histogram. Bin 0 counts times of 0. Bin n counts times from 2^(n-1) to 2^n - 1.
+    /// Bins stop counting at 0xFFFF.
+    uint16_t hist[EVENT_STATS_HIST_BINS];
+} event_timing_t;
+
+/// Dispatch statistics for one event handler
+typedef struct{
+    void (*fptr)(void);     ///< Event handler. NULL if the slot holds all the handlers that did not fit
+    uint32_t count;         ///< Number of times the handler was dispatched
+    event_timing_t latency; ///< Time from the event being pushed until its handler was called
+    event_timing_t runtime; ///< Time spent in the handler, including any events it yielded to
+} event_stats_t;
+
+/// What happens to an event that does not fit in the queue. See event_SetOverflowPolicy().
+typedef enum{
+    EVENT_OVF_DROP_NEWEST = 0,  ///< The new event is dropped and counted as lost (default)
+    EVENT_OVF_KEEP_LATEST,      ///< The new event is held and pushed once there is room. If another
+                                ///< one arrives before then, the older one is dropped.
+    EVENT_OVF_RESERVE           ///< The event may also use the \c EVENT_QUEUE_RESERVE bytes
+} event_ovf_policy_t;
+
+/// Event trace record types. See event_TraceDump().
+enum{
+    EVENT_TRACE_PUSH = 1,   ///< Event was pushed
+    EVENT_TRACE_DROP,       ///< Event push failed because the queue was full
+    EVENT_TRACE_DISPATCH,   ///< Handler was called. \c queued is the number of bytes left in its queue.
+    EVENT_TRACE_END,        ///< Handler returned, or the idle period ended
+    EVENT_TRACE_YIELD,      ///< Handler called event_YieldEvent()
+    EVENT_TRACE_IDLE        ///< Queue went idle. Repeated idle process calls are not recorded.
+};
+
+/// One event trace record (10 bytes on the MSP430, little-endian)
+typedef struct{
+    uint32_t fptr;      ///< Address of the handler
+    uint16_t time;      ///< event_stats_time() when the record was added
+    uint8_t type;       ///< Record type
+    uint8_t size;       ///< Event data bytes for PUSH, DROP and DISPATCH. Saturates at 255.
+    uint16_t queued;    ///< Bytes left in the handler's queue for DISPATCH. Saturates at 65535.
+} event_trace_rec_t;
+
 //==================================================================================================
 // Functions
 //==================================================================================================
@@ -124,9 +209,98 @@ void event_StartHandler(void);
 *    values. If pusing additional data with the event, the event called \e MUST have a matching
 *    event_PopEventData(). Every additional byte pushed into the event queue \e MUST be popped out
 *    regardless if it is used or not.
+* 
+*    The event and its data are added in a single atomic operation, so this function is safe to call
+*    from within an ISR.
 **/
 RES_t event_PushEvent(void (*fptr)(void), void *eventData, size_t size);
 
+/**
+* \brief Schedule a function to be called in the event queue at a given priority level
+* \param [in] fptr Pointer to the function to be called
+* \param [in] eventData Pointer to the data to be pushed into the queue (If not used, enter \c NULL)
+* \param [in] size Number of bytes to be pushed (if none required, use size of 0)
+* \param [in] prio Priority level, from 0 (lowest) to <tt>EVENT_QUEUE_PRIO_LEVELS-1</tt> (highest)
+* \retval RES_OK    Event added successfully
+* \retval RES_FULL    Not enough room in the queue for this level. Event was not added.
+* \retval RES_PARAMERR    \c prio is not a valid priority level
+* \details Same as event_PushEvent(), except that the event is dispatched before any pending events
+*    of a lower priority. Events of the same priority are dispatched in order. A running event is
+*    never interrupted by a higher priority one.
+**/
+RES_t event_PushEventPrio(void (*fptr)(void), void *eventData, size_t size, uint8_t prio);
+
+/**
+* \brief Schedule a function to be called in the event queue unless it is already pending
+* \param [in] fptr Pointer to the function to be called
+* \param [in] eventData Pointer to the data to be pushed into the queue (If not used, enter \c NULL)
+* \param [in] size Number of bytes to be pushed (if none required, use size of 0)
+* \retval RES_OK    Event added successfully, or it was already pending
+* \retval RES_FULL    Not enough room in the event queue, or too many different handlers are pending
+*   through this function (\c EVENT_UNIQUE_SLOTS). Event was not added.
+* \details Same as event_PushEvent(), except that nothing is done if \c fptr was already pushed
+*   using this function and has not been dispatched yet. The new \c eventData is discarded in that
+*   case. Once the handler starts running, it can be pushed again.
+* 
+*   The pending handlers are kept in a small hash set, so the queue is never searched. If
+*   \c EVENT_UNIQUE_SLOTS is 0 (the default), this is the same as event_PushEvent(). Handlers pushed
+*   using event_PushEvent() are not tracked, so mixing both for the same handler may queue it twice.
+**/
+RES_t event_PushEventUnique(void (*fptr)(void), void *eventData, size_t size);
+
+/**
+* \brief Sets what happens when events of a handler don't fit in the queue
+* \param [in] fptr Event handler (the source of the events)
+* \param [in] policy Overflow policy
+* \param [in] onFull Backpressure callback. Called each time an event of this handler does not fit,
+*   from the context of the push, which may be an ISR. The source can use it to slow down, for
+*   example by disabling its interrupt for a while. If not used, enter \c NULL.
+* \retval RES_OK    Policy set. The handler's lost event count is cleared.
+* \retval RES_FULL    All \c EVENT_OVF_SOURCES slots are in use
+* \details Handlers without a policy behave as \ref EVENT_OVF_DROP_NEWEST.
+* 
+*   With \ref EVENT_OVF_KEEP_LATEST, a held event makes event_PushEvent() return \c RES_OK. Only events
+*   with up to \c EVENT_OVF_DATA_MAX bytes of data can be held. Larger ones are dropped. Held events
+*   are pushed by the event handler loop before it dispatches the next event.
+* 
+*   Call this from main context.
+**/
+RES_t event_SetOverflowPolicy(void (*fptr)(void), event_ovf_policy_t policy, void (*onFull)(void));
+
+/**
+* \brief Returns the number of events of a handler that were lost because the queue was full
+* \param [in] fptr Event handler, or \c NULL
+* \return Number of lost events (saturates at 65535). If \c fptr has no overflow policy, or is
+*   \c NULL, the total for all handlers without a policy is returned.
+**/
+uint16_t event_GetLostCount(void (*fptr)(void));
+
+/**
+* \brief Runs a handler in its own cooperative thread
+* \param [in] fptr Event handler
+* \retval RES_OK    Handler registered
+* \retval RES_FULL    All \c EVENT_THREAD_HANDLERS slots are in use, or \c EVENT_COTHREADS is 0
+* \details Only available if \c EVENT_COTHREADS is greater than 0. Requires the \ref MOD_COTHREADS
+*   module.
+* 
+*   When the handler is dispatched, it is started in one of \c EVENT_COTHREADS pooled threads, each
+*   with a stack of \c EVENT_COTHREAD_STACK_SIZE bytes. When it calls event_YieldEvent(), it is
+*   suspended and put back at the end of the queue of its priority level. Other events run on the
+*   main stack in the meantime, and the handler continues once its turn comes. Yielding from a
+*   thread is not limited by \c MAX_YIELD_DEPTH and does not use more stack.
+* 
+*   The handler must pop all of its event data before it yields for the first time. If no thread is
+*   free, the handler runs on the main stack like any other.
+*   
+*   A threaded handler never runs twice at once. If it is dispatched again while an earlier call is
+*   suspended, the earlier call is resumed first and runs to the end without giving up the CPU when
+*   it yields. Then the new call is started.
+* 
+*   The event handler owns the \ref MOD_COTHREADS home thread, so the application must not call
+*   cothread_init() itself.
+**/
+RES_t event_SetThreaded(void (*fptr)(void));
+
 /**
 * \brief Pop event-related data out of the event queue
 * \param [in] dst Pointer to where the data will be read into
@@ -139,7 +313,11 @@ void event_PopEventData(void *dst, size_t size);
 /**
 * \brief Yields execution of the current event to the next pending event in the queue.
 * \details Calling this function allows the next event in the queue to be executed. If no events are
-*   in the queue or the next event is already active, the onIdle() event is processed.
+*   in the queue or the next event is already active, the onIdle() event is processed. If
+*   \c EVENT_IDLE_SLEEP is enabled, this function returns instead of sleeping.
+* 
+*   Handlers registered with event_SetThreaded() are suspended instead, and continue after the
+*   events that are already in the queue.
 * 
 *   event_YieldEvent() can be called occasionally when performing a time-consuming operation
 *   within an event such as a polling loop. Doing so allows other events that may have piled up in
@@ -150,11 +328,69 @@ void event_YieldEvent(void);
 
 /**
 * \brief Returns /c true if an event is in the queue
-* \retval true An event is in the queue
+* \retval true An event is in the queue (at any priority level)
 * \retval false The event queue is empty
 **/
 bool event_Pending(void);
 
+/**
+* \brief Get the dispatch statistics of an event handler
+* \param [in] idx Statistics slot, starting at 0
+* \return Pointer to the slot's statistics. NULL if \c idx is past the last slot in use.
+* \details Only available if \c EVENT_QUEUE_STATS is set to 1. Otherwise, always returns \c NULL.
+*   Each event handler gets its own slot the first time it is dispatched. Once all
+*   \c EVENT_STATS_SLOTS slots are in use, the last slot counts every handler that did not get its
+*   own slot, and its \c fptr is \c NULL.
+* 
+*   To list every handler, increment \c idx from 0 until \c NULL is returned. The statistics are
+*   only updated by the event handler loop, so they can be read safely from within an event.
+**/
+const event_stats_t* event_GetStats(uint8_t idx);
+
+/**
+* \brief Clears all event handler statistics
+**/
+void event_ResetStats(void);
+
+/**
+* \brief Enables or disables the event trace recorder
+* \param [in] enable Set to \c false to freeze the trace, for example once a stall has been detected.
+* \details Only available if \c EVENT_QUEUE_TRACE is set to 1. The recorder is enabled by event_init().
+**/
+void event_TraceEnable(bool enable);
+
+/**
+* \brief Writes the contents of the event trace buffer
+* \param [in] write Function that sends the data somewhere. uart_write() can be used directly.
+* \details Only available if \c EVENT_QUEUE_TRACE is set to 1. Otherwise, nothing is written.
+* 
+*   The dump starts with an 8 byte header: the characters "EVTR", a version byte (2), the size of a
+*   record in bytes and the number of records as a 16-bit little-endian value. The records follow,
+*   oldest first. Recording is paused while dumping.
+* 
+*   Use \c tools/event_trace.py to turn a dump into a Chrome trace (chrome://tracing) with the
+*   handler names taken from the firmware's ELF file.
+* 
+*   To dump over USB or into a file, wrap the write function:
+* \code
+*     static void trace_to_file(void *buf, size_t size){
+*         ffs_fwrite(buf, size, &trace_file);
+*     }
+*     ...
+*     event_TraceDump(trace_to_file);
+* \endcode
+**/
+void event_TraceDump(void (*write)(void *buf, size_t size));
+
+/**
+* \brief Timestamp source for the event statistics and trace. Must be provided by the application.
+* \return Value of a free-running 16-bit timer (for example: <tt>return(TA0R);</tt>)
+* \details Only used if \c EVENT_QUEUE_STATS or \c EVENT_QUEUE_TRACE is set to 1. It is called by
+*   event_PushEvent(), which may be called from an ISR. Latencies or run times longer than one timer
+*   period wrap around, so pick a timer clock slow enough for the longest times you expect.
+**/
+uint16_t event_stats_time(void);
+
 //==================================================================================================
 // Events
 //==================================================================================================
@@ -166,6 +402,9 @@ bool event_Pending(void);
 * \brief Idle process event
 * \details This event is called repeatedly when there are no events pending. \n
 *    \b NOTE: As with any other event, a new event cannot be called until the current one exits.
+* 
+*    Not used if \c EVENT_IDLE_SLEEP is set to 1. If it is set to 2, it is only called once each
+*    time the queue becomes empty. Use event_emu_wake() to have it called again.
 **/
 extern void onIdle(void);
 
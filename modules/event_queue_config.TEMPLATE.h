@@ -18,13 +18,99 @@
 //==================================================================================================
 
 
-/// Number of bytes to reserve for the event queue
+/// Number of bytes to reserve for the event queue. Each priority level gets its own queue of this size.
 #define EVENT_QUEUE_SIZE    128 ///< \hideinitializer
 
 
+/// Number of event priority levels (1 to 8)
+#define EVENT_QUEUE_PRIO_LEVELS 1 ///< \hideinitializer
+/**<    Pending events in a higher level are always dispatched before any event in a lower level.
+*       Events within a level are dispatched in the order they were pushed.
+**/
+
+/// Priority level used by event_PushEvent(). 0 is the lowest priority.
+#define EVENT_PRIO_DEFAULT  0 ///< \hideinitializer
+
+
+/// Use the statically sized power-of-two FIFO implementation for the event queue
+#define EVENT_QUEUE_POW2    0 ///< \hideinitializer
+/**<    0 = Generic #FIFO_t (any queue size) \n
+*       1 = FIFO_DECLARE() FIFO. EVENT_QUEUE_SIZE must be a power of two.
+**/
+
+
+/// Number of bytes at the end of each queue that only \c EVENT_OVF_RESERVE sources may use
+#define EVENT_QUEUE_RESERVE 0 ///< \hideinitializer
+/**<    Keeps room for critical events when the queue is flooded by others.
+**/
+
+/// Number of handlers that can have an overflow policy set using event_SetOverflowPolicy()
+#define EVENT_OVF_SOURCES   0 ///< \hideinitializer
+
+/// Largest event data that an \c EVENT_OVF_KEEP_LATEST source can hold while the queue is full
+#define EVENT_OVF_DATA_MAX  4 ///< \hideinitializer
+
+
+/// Maximum number of different handlers that can be pending through event_PushEventUnique()
+#define EVENT_UNIQUE_SLOTS  0 ///< \hideinitializer
+/**<    Must be 0 or a power of two. 0 disables the coalescing, which saves a lookup on every
+*       dispatched event.
+**/
+
+
 /// Maximum number of yielded event levels
 #define MAX_YIELD_DEPTH        2 ///< \hideinitializer
 
+
+/// Number of pooled threads for handlers registered with event_SetThreaded()
+#define EVENT_COTHREADS     0 ///< \hideinitializer
+/**<    0 disables threaded handlers. Otherwise, requires the \ref MOD_COTHREADS module.
+**/
+
+/// Stack size of each pooled thread in bytes
+#define EVENT_COTHREAD_STACK_SIZE   256 ///< \hideinitializer
+
+/// Maximum number of handlers that can be registered with event_SetThreaded()
+#define EVENT_THREAD_HANDLERS   4 ///< \hideinitializer
+
+
+/// Idle policy of the event handler
+#define EVENT_IDLE_SLEEP    0 ///< \hideinitializer
+/**<    0 = onIdle() is called when no events are pending. It must be provided by the application. \n
+*       1 = The CPU sleeps in EVENT_IDLE_LPM_BITS when no events are pending. ISRs that push events
+*           must wake it using EVENT_WAKE_ON_EXIT(). onIdle() is not used. \n
+*       2 = Host builds only (modules/emulate). onIdle() is called once each time the queue becomes
+*           empty, then the handler thread blocks until an event is pushed.
+**/
+
+/// Low-power mode used by the built-in idle
+#define EVENT_IDLE_LPM_BITS LPM0_bits ///< \hideinitializer
+/**<    Deeper modes are only safe if the clocks of all event sources keep running in them.
+**/
+
+
+/// Measure event dispatch latency and handler run times
+#define EVENT_QUEUE_STATS   0 ///< \hideinitializer
+/**<    0 = Disabled \n
+*       1 = Each event is timestamped with event_stats_time() when it is pushed. This adds 2 bytes
+*           to every event in the queue. Results are read with event_GetStats().
+**/
+
+/// Number of event handlers that statistics are kept for
+#define EVENT_STATS_SLOTS   8 ///< \hideinitializer
+
+
+/// Record a trace of the event queue's activity
+#define EVENT_QUEUE_TRACE   0 ///< \hideinitializer
+/**<    0 = Disabled \n
+*       1 = Every push, dispatch, yield and idle is recorded into a ring buffer along with an
+*           event_stats_time() timestamp. The buffer is read using event_TraceDump(). Each event
+*           takes one more byte in the queue to record its data size.
+**/
+
+/// Number of trace records kept. Each record takes 10 bytes.
+#define EVENT_TRACE_RECORDS 64 ///< \hideinitializer
+
 ///\}    
 #endif
 ///\}
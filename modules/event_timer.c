@@ -0,0 +1,231 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_EVENT_TIMER
+* \{
+**/
+
+/**
+* \file
+* \brief Code for \ref MOD_EVENT_TIMER
+* \author Alex Mykyta 
+**/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <result.h>
+
+#include "timer.h"
+#include "event_queue.h"
+#include "event_timer.h"
+#include <event_timer_config.h>
+
+#if(EVENT_TIMER_ARENA_SIZE > 0xFFFF)
+    #error "EVENT_TIMER_ARENA_SIZE must be less than 65536"
+#endif
+
+#if(EVENT_TIMER_SLOTS > 255)
+    #error "EVENT_TIMER_SLOTS must be less than 256"
+#endif
+
+//==================================================================================================
+// Internal Variables
+//==================================================================================================
+
+enum{
+    SLOT_FREE = 0,
+    SLOT_ACTIVE
+};
+
+typedef struct{
+    timer_t timer;
+    void (*fptr)(void);
+    uint16_t offset;    // Location of the event data in Arena
+    uint16_t size;      // Size of the event data
+    bool repeat;
+    uint8_t state;
+    uint8_t gen;        // Incremented every time the slot is started
+} evtmr_slot_t;
+
+// Timer event data. Identifies a slot and the generation it was started in, so that an expiration
+// that is still in the event queue after the slot was canceled (and maybe reused) is ignored.
+#define SLOT_TAG(idx, gen)  ((void*)(uintptr_t)(((uint16_t)(gen) << 8) | (idx)))
+#define TAG_IDX(tag)        ((uint8_t)(uintptr_t)(tag))
+#define TAG_GEN(tag)        ((uint8_t)((uintptr_t)(tag) >> 8))
+
+static evtmr_slot_t Slots[EVENT_TIMER_SLOTS];
+static uint8_t Arena[EVENT_TIMER_ARENA_SIZE];
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// Checks if the arena block at offset is not used by any active slot
+static bool ArenaBlockFree(uint16_t offset, uint16_t size){
+    uint8_t i;
+    
+    if(((uint32_t)offset + size) > EVENT_TIMER_ARENA_SIZE){
+        return(false);
+    }
+    
+    for(i=0; i<EVENT_TIMER_SLOTS; i++){
+        if((Slots[i].state == SLOT_ACTIVE) && (Slots[i].size != 0)){
+            if((offset < (Slots[i].offset + Slots[i].size)) && (Slots[i].offset < (offset + size))){
+                return(false);
+            }
+        }
+    }
+    return(true);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Finds room for size bytes in the arena (first fit). Returns false if there is none.
+static bool ArenaAlloc(uint16_t size, uint16_t *offset){
+    uint8_t i;
+    
+    // A free block can only start at the beginning of the arena or right after a used block.
+    if((size == 0) || ArenaBlockFree(0, size)){
+        *offset = 0;
+        return(true);
+    }
+    
+    for(i=0; i<EVENT_TIMER_SLOTS; i++){
+        if(Slots[i].state == SLOT_ACTIVE){
+            *offset = Slots[i].offset + Slots[i].size;
+            if(ArenaBlockFree(*offset, size)){
+                return(true);
+            }
+        }
+    }
+    return(false);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Timer callback. Called from the event queue.
+static void SlotExpired(void *tag){
+    evtmr_slot_t *slot = &Slots[TAG_IDX(tag)];
+    
+    if((slot->state != SLOT_ACTIVE) || (slot->gen != TAG_GEN(tag))){
+        // Expired before it was canceled
+        return;
+    }
+    
+    event_PushEvent(slot->fptr, &Arena[slot->offset], slot->size);
+    
+    if(!slot->repeat){
+        // The timer module has already removed the timer from its list
+        slot->state = SLOT_FREE;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+static RES_t PushTimed(void (*fptr)(void), void *eventData, size_t size, uint16_t ms, bool repeat){
+    evtmr_slot_t *slot = NULL;
+    struct timerctl settings;
+    uint16_t offset;
+    uint8_t i;
+    
+    if(size > EVENT_TIMER_ARENA_SIZE){
+        return(RES_PARAMERR);
+    }
+    
+    for(i=0; i<EVENT_TIMER_SLOTS; i++){
+        if(Slots[i].state == SLOT_FREE){
+            slot = &Slots[i];
+            break;
+        }
+    }
+    
+    if(slot == NULL){
+        return(RES_FULL);
+    }
+    
+    if(!ArenaAlloc(size, &offset)){
+        return(RES_FULL);
+    }
+    
+    if(size){
+        memcpy(&Arena[offset], eventData, size);
+    }
+    slot->fptr = fptr;
+    slot->offset = offset;
+    slot->size = size;
+    slot->repeat = repeat;
+    slot->state = SLOT_ACTIVE;
+    slot->gen++;
+    
+    settings.interval_ms = ms;
+    settings.repeat = repeat;
+    settings.fptr = SlotExpired;
+    settings.ev_data = SLOT_TAG(i, slot->gen);
+    if(timer_start(&slot->timer, &settings) != RES_OK){
+        // Interval is out of the timer's range. Nothing was started, so free the slot again.
+        slot->state = SLOT_FREE;
+        return(RES_PARAMERR);
+    }
+    
+    return(RES_OK);
+}
+
+//==================================================================================================
+// Functions
+//==================================================================================================
+
+void event_timer_init(void){
+    memset(Slots, 0, sizeof(Slots));
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t event_PushEventDelayed(void (*fptr)(void), void *eventData, size_t size, uint16_t delay_ms){
+    return(PushTimed(fptr, eventData, size, delay_ms, false));
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t event_PushEventPeriodic(void (*fptr)(void), void *eventData, size_t size, uint16_t period_ms){
+    return(PushTimed(fptr, eventData, size, period_ms, true));
+}
+
+//--------------------------------------------------------------------------------------------------
+void event_CancelTimedEvents(void (*fptr)(void)){
+    evtmr_slot_t *slot;
+    uint8_t i;
+    
+    for(i=0; i<EVENT_TIMER_SLOTS; i++){
+        slot = &Slots[i];
+        if((slot->state == SLOT_ACTIVE) && (slot->fptr == fptr)){
+            timer_stop(&slot->timer);
+            
+            // An expiration that is already in the event queue is ignored since it carries the old
+            // generation, so the slot can be reused right away.
+            slot->state = SLOT_FREE;
+        }
+    }
+}
+
+///\}
@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_EVENT_TIMER Timed Events
+* \brief Delayed and periodic events without a caller-owned timer
+* \author Alex Mykyta 
+*
+* event_PushEventDelayed() and event_PushEventPeriodic() work like event_PushEvent(), except that the
+* event is pushed into the \ref MOD_EVENT_QUEUE after a delay, or repeatedly. The event data is copied
+* into an internal arena, and the timer is taken from an internal pool of \c EVENT_TIMER_SLOTS
+* slots, so the caller does not need to keep anything alive.
+*
+* All slots run on the \ref MOD_TIMER module, so expirations that fall in the same timer interrupt
+* are handled together.
+*
+* The event handler pops its data using event_PopEventData() just like any other event.
+*
+* \ref MOD_EVENT_TIMER also requires the following modules:
+*    - \ref MOD_TIMER
+*    - \ref MOD_EVENT_QUEUE
+*
+* \{
+**/
+
+/**
+* \file
+* \brief Include file for \ref MOD_EVENT_TIMER
+* \author Alex Mykyta 
+**/
+
+#ifndef EVENT_TIMER_H
+#define EVENT_TIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <result.h>
+
+//==================================================================================================
+// Function Prototypes
+//==================================================================================================
+
+/**
+* \brief Initializes the timed event slots
+* \details Must be called after timer_init() and event_init()
+**/
+void event_timer_init(void);
+
+/**
+* \brief Schedule an event to be pushed into the event queue after a delay
+* \param [in] fptr Pointer to the function to be called
+* \param [in] eventData Pointer to the data to be pushed with the event (If not used, enter \c NULL)
+* \param [in] size Number of bytes of data (if none required, use size of 0)
+* \param [in] delay_ms Delay in milliseconds. Must be within the range of \ref MOD_TIMER.
+* \retval RES_OK    Event scheduled successfully
+* \retval RES_FULL    No free slots, or not enough room in the arena for the data
+* \retval RES_PARAMERR    \c delay_ms can't be timed by \ref MOD_TIMER (0 for example), or \c size
+*   is larger than the arena
+* \details The data is copied, so \c eventData does not need to stay valid. This function must not be
+*   called from an ISR.
+**/
+RES_t event_PushEventDelayed(void (*fptr)(void), void *eventData, size_t size, uint16_t delay_ms);
+
+/**
+* \brief Schedule an event to be pushed into the event queue periodically
+* \param [in] fptr Pointer to the function to be called
+* \param [in] eventData Pointer to the data to be pushed with each event (If not used, enter \c NULL)
+* \param [in] size Number of bytes of data (if none required, use size of 0)
+* \param [in] period_ms Period in milliseconds. Must be within the range of \ref MOD_TIMER.
+* \retval RES_OK    Event scheduled successfully
+* \retval RES_FULL    No free slots, or not enough room in the arena for the data
+* \retval RES_PARAMERR    \c period_ms can't be timed by \ref MOD_TIMER (0 for example), or \c size
+*   is larger than the arena
+* \details The same copy of the data is pushed every period until the event is cancelled using
+*   event_CancelTimedEvents(). This function must not be called from an ISR.
+**/
+RES_t event_PushEventPeriodic(void (*fptr)(void), void *eventData, size_t size, uint16_t period_ms);
+
+/**
+* \brief Cancels all pending delayed and periodic events that call \c fptr
+* \param [in] fptr Event handler to cancel
+* \details Events that have already been pushed into the event queue are still dispatched. This
+*   function must not be called from an ISR.
+**/
+void event_CancelTimedEvents(void (*fptr)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+///\}
@@ -0,0 +1,4 @@
+
+########################################### Module Setup ###########################################
+MODULE_SOURCES += event_timer.c
+REQUIRED_MODULES += timer event_queue
@@ -0,0 +1,30 @@
+/**
+* \addtogroup MOD_EVENT_TIMER
+* \{
+**/
+
+/**
+* \file
+* \brief Configuration include file for \ref MOD_EVENT_TIMER
+* \author Alex Mykyta 
+**/
+
+#ifndef EVENT_TIMER_CONFIG_H
+#define EVENT_TIMER_CONFIG_H
+
+//==================================================================================================
+/// \name Configuration
+/// Configuration defines for the \ref MOD_EVENT_TIMER module
+/// \{
+//==================================================================================================
+
+/// Maximum number of delayed or periodic events that can be pending at once
+#define EVENT_TIMER_SLOTS       8    ///< \hideinitializer
+
+/// Number of bytes reserved for the event data of all pending delayed and periodic events
+#define EVENT_TIMER_ARENA_SIZE  64    ///< \hideinitializer
+
+///\}
+    
+#endif
+///\}
@@ -52,7 +52,160 @@
 
 #include "fifo.h"
 
+// The MSP430 is single-core, so a compiler barrier is enough to keep buffer accesses from being
+// reordered around the index store that publishes them.
+#define FIFO_BARRIER()      __asm__ __volatile__("" ::: "memory")
+
+// Access to an index that the other side of a SPSC FIFO may modify at any time
+#define FIFO_IDX(x)         (*(volatile size_t *)&(x))
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// Number of bytes stored in the FIFO for a given snapshot of the indexes
+static size_t used_count(FIFO_t *fifo, size_t wridx, size_t rdidx){
+    if(wridx >= rdidx){
+        return(wridx-rdidx);
+    }else{
+        return((fifo->bufsize-rdidx)+wridx);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Number of bytes free in the FIFO for a given snapshot of the indexes
+static size_t free_count(FIFO_t *fifo, size_t wridx, size_t rdidx){
+    if(rdidx >= wridx+1){
+        return(rdidx-wridx-1);
+    }else{
+        return((fifo->bufsize-wridx)+rdidx-1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Copies data into the buffer starting at wridx. Returns the new write index.
+// The caller is responsible for publishing it.
+static size_t copy_in(FIFO_t *fifo, size_t wridx, void *src, size_t size){
+    size_t wrcount;
+    
+    if((wrcount = fifo->bufsize - wridx) <= size){
+        // write operation will wrap around in fifo
+        // write first half of fifo
+        memcpy(fifo->bufptr+wridx, src, wrcount);
+        
+        //wrap around and continue
+        wridx = 0;
+        size -= wrcount;
+        src = (uint8_t*)src + wrcount;
+    }
+    
+    if(size > 0){
+        memcpy(fifo->bufptr+wridx, src, size);
+        wridx += size;
+    }
+    
+    return(wridx);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Copies data out of the buffer starting at rdidx. A NULL dst discards the data.
+// Returns the new read index. The caller is responsible for publishing it.
+static size_t copy_out(FIFO_t *fifo, size_t rdidx, void *dst, size_t size){
+    size_t rdcount;
+    
+    if((rdcount = fifo->bufsize - rdidx) <= size){
+        // read operation will wrap around in fifo
+        // read first half of fifo
+        if(dst != NULL){
+            memcpy(dst, fifo->bufptr + rdidx, rdcount);
+            dst = (uint8_t*)dst + rdcount;
+        }
+        //wrap around and continue
+        rdidx = 0;
+        size -= rdcount;
+    }
+    
+    if(size > 0){
+        if(dst != NULL){
+            memcpy(dst, fifo->bufptr + rdidx, size);
+        }
+        rdidx += size;
+    }
+    
+    return(rdidx);
+}
+
 //--------------------------------------------------------------------------------------------------
+#if(FIFO_TELEMETRY == 1)
+
+#if(FIFO_TELEMETRY_TIME == 1)
+    #define FIFO_TELEMETRY_TIME_NOW()   fifo_telemetry_time()
+#else
+    #define FIFO_TELEMETRY_TIME_NOW()   0
+#endif
+
+static FIFO_t *fifo_registry = NULL;
+
+// Updates the counters after size bytes were added. wridx and rdidx are the indexes after the write.
+// Must be called with interrupts disabled. SPSC producers call this in the same atomic section that
+// publishes wridx so that the consumer can't see a full FIFO before it is marked as full.
+static void stats_written(FIFO_t *fifo, size_t size, size_t wridx, size_t rdidx){
+    size_t used;
+    
+    fifo->stats.bytes_in += size;
+    
+    used = used_count(fifo, wridx, rdidx);
+    if(used > fifo->stats.high_water){
+        fifo->stats.high_water = used;
+    }
+    
+    if(!fifo->is_full && (used == fifo->bufsize-1)){
+        fifo->is_full = 1;
+        fifo->full_since = FIFO_TELEMETRY_TIME_NOW();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Updates the counters after size bytes were removed. Must be called with interrupts disabled.
+// SPSC consumers call this in the same atomic section that publishes rdidx.
+static void stats_removed(FIFO_t *fifo, size_t size){
+    fifo->stats.bytes_out += size;
+    
+    if(fifo->is_full && (size > 0)){
+        fifo->is_full = 0;
+        fifo->stats.full_time += FIFO_TELEMETRY_TIME_NOW() - fifo->full_since;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Updates the counters after fifo_write_trample() wrote size bytes into a FIFO that held used bytes
+static void stats_trampled(FIFO_t *fifo, size_t size, size_t used){
+    size_t capacity = fifo->bufsize-1;
+    
+    // Only the tail of an oversized write is stored
+    if(size > capacity){
+        size = capacity;
+    }
+    
+    if(used + size > capacity){
+        fifo->stats.trampled += used + size - capacity;
+    }
+    
+    stats_written(fifo, size, fifo->wridx, fifo->rdidx);
+}
+
+    #define STATS_WRITTEN(fifo, size, wridx, rdidx)  stats_written(fifo, size, wridx, rdidx)
+    #define STATS_REMOVED(fifo, size)                stats_removed(fifo, size)
+    #define STATS_REJECTED(fifo)                     (fifo)->stats.rejected++
+#else
+    #define STATS_WRITTEN(fifo, size, wridx, rdidx)
+    #define STATS_REMOVED(fifo, size)
+    #define STATS_REJECTED(fifo)
+#endif
+
+//==================================================================================================
+// Functions
+//==================================================================================================
 void fifo_init(FIFO_t *fifo, void *bufptr, size_t bufsize){
     fifo->bufptr = bufptr;
     fifo->bufsize = bufsize;
@@ -61,37 +214,63 @@ void fifo_init(FIFO_t *fifo, void *bufptr, size_t bufsize){
 #if(FIFO_LOG_MAX_USAGE == 1)
     fifo->max = 0;
 #endif
+#if(FIFO_TELEMETRY == 1)
+    // The registry fields are left alone so that a registered FIFO can be re-initialized
+    memset(&fifo->stats, 0, sizeof(fifo->stats));
+    fifo->is_full = 0;
+#endif
 }
 
 //--------------------------------------------------------------------------------------------------
 RES_t fifo_write(FIFO_t *fifo, void *src, size_t size){
-    size_t wrcount;
     
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
         if(size > fifo_wrcount(fifo)){
+            STATS_REJECTED(fifo);
             return(RES_FULL);
         }
+        
+        fifo->wridx = copy_in(fifo, fifo->wridx, src, size);
+        STATS_WRITTEN(fifo, size, fifo->wridx, fifo->rdidx);
+        
+        #if(FIFO_LOG_MAX_USAGE == 1)
+            size = fifo_rdcount(fifo);
+            if(size > fifo->max){
+                fifo->max = size;
+            }
+        #endif
+    }
+    
+    return(RES_OK);
+}
 
-        if((wrcount = fifo->bufsize - fifo->wridx) <= size){
-            // write operation will wrap around in fifo
-            // write first half of fifo
-            memcpy(fifo->bufptr+fifo->wridx,src,wrcount);
-            
-            //wrap around and continue
-            fifo->wridx = 0;
-            size -= wrcount;
-            src = (uint8_t*)src + wrcount;
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_writev(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt){
+    size_t total = 0;
+    size_t wridx;
+    size_t i;
+    
+    for(i=0; i<iovcnt; i++){
+        total += iov[i].len;
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(total > fifo_wrcount(fifo)){
+            STATS_REJECTED(fifo);
+            return(RES_FULL);
         }
-
-        if(size > 0){
-            memcpy(fifo->bufptr+fifo->wridx,src,size);
-            fifo->wridx += size;
+        
+        wridx = fifo->wridx;
+        for(i=0; i<iovcnt; i++){
+            wridx = copy_in(fifo, wridx, iov[i].buf, iov[i].len);
         }
+        fifo->wridx = wridx;
+        STATS_WRITTEN(fifo, total, fifo->wridx, fifo->rdidx);
         
         #if(FIFO_LOG_MAX_USAGE == 1)
-            wrcount = fifo_rdcount(fifo);
-            if(wrcount > fifo->max){
-                fifo->max = wrcount;
+            total = fifo_rdcount(fifo);
+            if(total > fifo->max){
+                fifo->max = total;
             }
         #endif
     }
@@ -103,6 +282,11 @@ RES_t fifo_write(FIFO_t *fifo, void *src, size_t size){
 void fifo_write_trample(FIFO_t *fifo, void *src, size_t size){
     
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        #if(FIFO_TELEMETRY == 1)
+            size_t total = size;
+            size_t used = used_count(fifo, fifo->wridx, fifo->rdidx);
+        #endif
+        
         if(size >= fifo->bufsize-1){
             // if writing more than can ever fit in the buffer,
             // only write the latter portion of src buf.
@@ -143,37 +327,49 @@ void fifo_write_trample(FIFO_t *fifo, void *src, size_t size){
                 }
             }
         }
+        
+        #if(FIFO_TELEMETRY == 1)
+            stats_trampled(fifo, total, used);
+        #endif
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size){
-    size_t rdcount;
     
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
         if(size > fifo_rdcount(fifo)){
             return(RES_PARAMERR);
         }
         
-        rdcount = fifo->bufsize - fifo->rdidx;
-        if(rdcount <= size){
-            // read operation will wrap around in fifo
-            // read first half of fifo
-            if(dst != NULL){
-                memcpy(dst, fifo->bufptr + fifo->rdidx, rdcount);
-            }
-            //wrap around and continue
-            fifo->rdidx = 0;
-            size -= rdcount;
-            dst = (uint8_t*)dst + rdcount;
+        fifo->rdidx = copy_out(fifo, fifo->rdidx, dst, size);
+        STATS_REMOVED(fifo, size);
+    }
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_readv(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt){
+    size_t total = 0;
+    size_t rdidx;
+    size_t i;
+    
+    for(i=0; i<iovcnt; i++){
+        total += iov[i].len;
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(total > fifo_rdcount(fifo)){
+            return(RES_PARAMERR);
         }
         
-        if(size > 0){
-            if(dst != NULL){
-                memcpy(dst, fifo->bufptr + fifo->rdidx, size);
-            }
-            fifo->rdidx += size;
+        rdidx = fifo->rdidx;
+        for(i=0; i<iovcnt; i++){
+            rdidx = copy_out(fifo, rdidx, iov[i].buf, iov[i].len);
         }
+        fifo->rdidx = rdidx;
+        STATS_REMOVED(fifo, total);
     }
     
     return(RES_OK);
@@ -181,65 +377,163 @@ RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size){
 
 //--------------------------------------------------------------------------------------------------
 size_t fifo_read_max(FIFO_t *fifo, void *dst, size_t max_size){
-    size_t rdcount, nbytes;
+    size_t rdcount;
     
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
         rdcount = fifo_rdcount(fifo);
         if(max_size > rdcount){
             max_size = rdcount;
         }
-        nbytes = max_size;
         
-        rdcount = fifo->bufsize - fifo->rdidx;
-        if(rdcount <= nbytes){
-            // read operation will wrap around in fifo
-            // read first half of fifo
-            if(dst != NULL){
-                memcpy(dst, fifo->bufptr + fifo->rdidx, rdcount);
-            }
-            //wrap around and continue
-            fifo->rdidx = 0;
-            nbytes -= rdcount;
-            dst = (uint8_t*)dst + rdcount;
-        }
+        fifo->rdidx = copy_out(fifo, fifo->rdidx, dst, max_size);
+        STATS_REMOVED(fifo, max_size);
+    }
+    
+    return(max_size);
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t fifo_read_wait(FIFO_t *fifo, void *dst, size_t size, uint32_t timeout){
+    size_t total = 0;
+    size_t rdcount;
+    #if(FIFO_WAIT_TIMEOUT == 1)
+        uint32_t start;
+    #endif
+    
+    // The FIFO is only checked with interrupts disabled. The caller's GIE state is restored on return.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        #if(FIFO_WAIT_TIMEOUT == 1)
+            start = fifo_wait_time();
+        #endif
         
-        if(nbytes > 0){
+        while(total < size){
+            rdcount = used_count(fifo, fifo->wridx, fifo->rdidx);
+            if(rdcount == 0){
+                #if(FIFO_WAIT_TIMEOUT == 1)
+                    if((timeout != 0) && ((fifo_wait_time() - start) >= timeout)){
+                        break;
+                    }
+                #endif
+                
+                // Setting GIE and the LPM bits in one instruction closes the window where the
+                // producer's interrupt could run between the check above and going to sleep.
+                __bis_SR_register(FIFO_WAIT_LPM_BITS | GIE);
+                __no_operation();
+                __disable_interrupt();
+                __no_operation();
+                continue;
+            }
+            
+            if(rdcount > size - total){
+                rdcount = size - total;
+            }
+            
+            fifo->rdidx = copy_out(fifo, fifo->rdidx, dst, rdcount);
+            STATS_REMOVED(fifo, rdcount);
+            
             if(dst != NULL){
-                memcpy(dst, fifo->bufptr + fifo->rdidx, nbytes);
+                dst = (uint8_t*)dst + rdcount;
             }
-            fifo->rdidx += nbytes;
+            total += rdcount;
         }
     }
     
-    return(max_size);
+    return(total);
 }
 
 //--------------------------------------------------------------------------------------------------
 RES_t fifo_peek(FIFO_t *fifo, void *dst, size_t size){
-    size_t rdcount;
-    size_t rdidx;
     
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
         if(size > fifo_rdcount(fifo)){
             return(RES_PARAMERR);
         }
         
+        copy_out(fifo, fifo->rdidx, dst, size);
+    }
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+void *fifo_write_reserve(FIFO_t *fifo, size_t *size){
+    size_t wridx,rdidx;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        wridx = fifo->wridx;
         rdidx = fifo->rdidx;
+    }
+    
+    if(rdidx > wridx){
+        *size = rdidx-wridx-1;
+    }else if(rdidx == 0){
+        // Last byte of the buffer must stay empty
+        *size = fifo->bufsize-wridx-1;
+    }else{
+        *size = fifo->bufsize-wridx;
+    }
+    
+    return(fifo->bufptr + wridx);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_write_commit(FIFO_t *fifo, size_t size){
+    size_t contig;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        fifo_write_reserve(fifo, &contig);
+        if(size > contig){
+            return(RES_PARAMERR);
+        }
         
-        if((rdcount = fifo->bufsize - rdidx) <= size){
-            // read operation will wrap around in fifo
-            // read first half of fifo
-            memcpy(dst,fifo->bufptr+rdidx,rdcount);
-            //wrap around and continue
-            rdidx = 0;
-            size -= rdcount;
-            dst = (uint8_t*)dst + rdcount;
+        fifo->wridx += size;
+        if(fifo->wridx == fifo->bufsize){
+            fifo->wridx = 0;
+        }
+        STATS_WRITTEN(fifo, size, fifo->wridx, fifo->rdidx);
+        
+        #if(FIFO_LOG_MAX_USAGE == 1)
+            contig = fifo_rdcount(fifo);
+            if(contig > fifo->max){
+                fifo->max = contig;
+            }
+        #endif
+    }
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+void *fifo_read_peek_contig(FIFO_t *fifo, size_t *size){
+    size_t wridx,rdidx;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        wridx = fifo->wridx;
+        rdidx = fifo->rdidx;
+    }
+    
+    if(wridx >= rdidx){
+        *size = wridx-rdidx;
+    }else{
+        *size = fifo->bufsize-rdidx;
+    }
+    
+    return(fifo->bufptr + rdidx);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_read_consume(FIFO_t *fifo, size_t size){
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(size > fifo_rdcount(fifo)){
+            return(RES_PARAMERR);
         }
         
-        if(size > 0){
-            memcpy(dst,fifo->bufptr+rdidx,size);
-            rdidx += size;
+        fifo->rdidx += size;
+        if(fifo->rdidx >= fifo->bufsize){
+            fifo->rdidx -= fifo->bufsize;
         }
+        STATS_REMOVED(fifo, size);
     }
     
     return(RES_OK);
@@ -248,6 +542,7 @@ RES_t fifo_peek(FIFO_t *fifo, void *dst, size_t size){
 //--------------------------------------------------------------------------------------------------
 void fifo_clear(FIFO_t *fifo){
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        STATS_REMOVED(fifo, used_count(fifo, fifo->wridx, fifo->rdidx));
         fifo->rdidx = 0;
         fifo->wridx = 0;
     }
@@ -261,11 +556,7 @@ size_t fifo_rdcount(FIFO_t *fifo){
         rdidx = fifo->rdidx;
     }
     
-    if(wridx >= rdidx){
-        return(wridx-rdidx);
-    }else{
-        return((fifo->bufsize-rdidx)+wridx);
-    }
+    return(used_count(fifo, wridx, rdidx));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -276,11 +567,222 @@ size_t fifo_wrcount(FIFO_t *fifo){
         rdidx = fifo->rdidx;
     }
     
-    if(rdidx >= wridx+1){
-        return(rdidx-wridx-1);
-    }else{
-        return((fifo->bufsize-wridx)+rdidx-1);
+    return(free_count(fifo, wridx, rdidx));
+}
+
+//==================================================================================================
+// Telemetry Functions
+//==================================================================================================
+#if(FIFO_TELEMETRY == 1)
+
+void fifo_register(FIFO_t *fifo, const char *name){
+    FIFO_t *f;
+    
+    fifo->name = name;
+    
+    for(f = fifo_registry; f != NULL; f = f->next){
+        if(f == fifo) return;
     }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        fifo->next = fifo_registry;
+        fifo_registry = fifo;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+FIFO_t *fifo_registry_next(FIFO_t *fifo){
+    if(fifo == NULL){
+        return(fifo_registry);
+    }
+    return(fifo->next);
+}
+
+//--------------------------------------------------------------------------------------------------
+void fifo_get_stats(FIFO_t *fifo, fifo_stats_t *stats){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        *stats = fifo->stats;
+        if(fifo->is_full){
+            stats->full_time += FIFO_TELEMETRY_TIME_NOW() - fifo->full_since;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+void fifo_reset_stats(FIFO_t *fifo){
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        memset(&fifo->stats, 0, sizeof(fifo->stats));
+        fifo->stats.high_water = used_count(fifo, fifo->wridx, fifo->rdidx);
+        if(fifo->is_full){
+            fifo->full_since = FIFO_TELEMETRY_TIME_NOW();
+        }
+    }
+}
+
+#endif
+
+//==================================================================================================
+// Single-Producer/Single-Consumer Functions
+//==================================================================================================
+// The producer is the only one that stores wridx and the consumer is the only one that stores rdidx.
+// Each side snapshots the other's index, moves the data, and then publishes its own index with a
+// single store. No interrupt masking is required, except to update the shared telemetry counters.
+
+RES_t fifo_spsc_write(FIFO_t *fifo, void *src, size_t size){
+    size_t wridx;
+    
+    wridx = fifo->wridx;
+    if(size > free_count(fifo, wridx, FIFO_IDX(fifo->rdidx))){
+        STATS_REJECTED(fifo);
+        return(RES_FULL);
+    }
+    
+    wridx = copy_in(fifo, wridx, src, size);
+    
+    // Data must be in the buffer before the consumer is allowed to see it
+    FIFO_BARRIER();
+    #if(FIFO_TELEMETRY == 1)
+        // The counters are shared with the consumer
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            stats_written(fifo, size, wridx, FIFO_IDX(fifo->rdidx));
+            FIFO_IDX(fifo->wridx) = wridx;
+        }
+    #else
+        FIFO_IDX(fifo->wridx) = wridx;
+    #endif
+    
+    #if(FIFO_LOG_MAX_USAGE == 1)
+        size = used_count(fifo, wridx, FIFO_IDX(fifo->rdidx));
+        if(size > fifo->max){
+            fifo->max = size;
+        }
+    #endif
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_spsc_read(FIFO_t *fifo, void *dst, size_t size){
+    size_t rdidx;
+    
+    rdidx = fifo->rdidx;
+    if(size > used_count(fifo, FIFO_IDX(fifo->wridx), rdidx)){
+        return(RES_PARAMERR);
+    }
+    
+    // Don't let the buffer reads get hoisted above the wridx snapshot
+    FIFO_BARRIER();
+    rdidx = copy_out(fifo, rdidx, dst, size);
+    
+    // Data must be out of the buffer before the producer is allowed to overwrite it
+    FIFO_BARRIER();
+    #if(FIFO_TELEMETRY == 1)
+        // The counters are shared with the producer
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            stats_removed(fifo, size);
+            FIFO_IDX(fifo->rdidx) = rdidx;
+        }
+    #else
+        FIFO_IDX(fifo->rdidx) = rdidx;
+    #endif
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_spsc_peek(FIFO_t *fifo, void *dst, size_t size){
+    size_t rdidx;
+    
+    rdidx = fifo->rdidx;
+    if(size > used_count(fifo, FIFO_IDX(fifo->wridx), rdidx)){
+        return(RES_PARAMERR);
+    }
+    
+    FIFO_BARRIER();
+    copy_out(fifo, rdidx, dst, size);
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t fifo_spsc_rdcount(FIFO_t *fifo){
+    return(used_count(fifo, FIFO_IDX(fifo->wridx), FIFO_IDX(fifo->rdidx)));
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t fifo_spsc_wrcount(FIFO_t *fifo){
+    return(free_count(fifo, FIFO_IDX(fifo->wridx), FIFO_IDX(fifo->rdidx)));
+}
+
+//==================================================================================================
+// Record FIFO Functions
+//==================================================================================================
+void rfifo_init(rfifo_t *rfifo, void *bufptr, size_t bufsize, size_t elsize){
+    // Trim the buffer so that it holds a whole number of records (plus the FIFO's empty slot)
+    if(bufsize > 0){
+        bufsize = ((bufsize-1) / elsize) * elsize + 1;
+    }
+    
+    fifo_init(&rfifo->fifo, bufptr, bufsize);
+    rfifo->elsize = elsize;
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t rfifo_push_n(rfifo_t *rfifo, void *src, size_t count){
+    FIFO_t *fifo = &rfifo->fifo;
+    size_t nrec;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        nrec = free_count(fifo, fifo->wridx, fifo->rdidx) / rfifo->elsize;
+        if(count > nrec){
+            STATS_REJECTED(fifo);
+            count = nrec;
+        }
+        
+        if(count > 0){
+            fifo->wridx = copy_in(fifo, fifo->wridx, src, count * rfifo->elsize);
+            STATS_WRITTEN(fifo, count * rfifo->elsize, fifo->wridx, fifo->rdidx);
+            
+            #if(FIFO_LOG_MAX_USAGE == 1)
+                nrec = used_count(fifo, fifo->wridx, fifo->rdidx);
+                if(nrec > fifo->max){
+                    fifo->max = nrec;
+                }
+            #endif
+        }
+    }
+    
+    return(count);
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t rfifo_pop_n(rfifo_t *rfifo, void *dst, size_t count){
+    FIFO_t *fifo = &rfifo->fifo;
+    size_t nrec;
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        nrec = used_count(fifo, fifo->wridx, fifo->rdidx) / rfifo->elsize;
+        if(count > nrec){
+            count = nrec;
+        }
+        
+        if(count > 0){
+            fifo->rdidx = copy_out(fifo, fifo->rdidx, dst, count * rfifo->elsize);
+            STATS_REMOVED(fifo, count * rfifo->elsize);
+        }
+    }
+    
+    return(count);
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t rfifo_rdcount(rfifo_t *rfifo){
+    return(fifo_rdcount(&rfifo->fifo) / rfifo->elsize);
+}
+
+//--------------------------------------------------------------------------------------------------
+size_t rfifo_wrcount(rfifo_t *rfifo){
+    return(fifo_wrcount(&rfifo->fifo) / rfifo->elsize);
 }
 
 ///\}
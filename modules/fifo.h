@@ -30,6 +30,23 @@
 *
 * This module creates a generic First-in First-out ring buffer.
 *
+* All \c fifo_* functions are interrupt-safe and may be called from any number of producers and
+* consumers. If a FIFO only ever has one producer context and one consumer context (for example, a
+* receive ISR and the main loop), the \c fifo_spsc_* functions can be used instead. They never
+* disable interrupts. The two sets of functions must not be mixed on the same FIFO object.
+*
+* The FIFO module does not have a config header. Its options are set as compiler flags in the
+* project makefile (for example <tt>CFLAGS += -DFIFO_TELEMETRY=1</tt>):
+*   - \c FIFO_LOG_MAX_USAGE: When set to 1, \c max tracks the most bytes ever stored in a FIFO.
+*   - \c FIFO_TELEMETRY: When set to 1, each FIFO keeps a set of #fifo_stats_t counters and
+*     FIFOs can be listed by name using fifo_register() and fifo_registry_next().
+*   - \c FIFO_TELEMETRY_TIME: When set to 1, the application must provide fifo_telemetry_time(),
+*     which is used to measure how long each FIFO is full. Otherwise, \c full_time stays 0.
+*   - \c FIFO_WAIT_LPM_BITS: Low-power mode that fifo_read_wait() sleeps in. Defaults to
+*     \c LPM0_bits. Deeper modes are only safe if the producer's clock keeps running in them.
+*   - \c FIFO_WAIT_TIMEOUT: When set to 1, the application must provide fifo_wait_time(), which
+*     is used for the timeout of fifo_read_wait(). Otherwise, fifo_read_wait() waits forever.
+*
 * \{
 **/
 
@@ -50,12 +67,26 @@ extern "C" {
 #include <stddef.h>
 #include <result.h>
 
+#ifndef FIFO_WAIT_LPM_BITS
+    #define FIFO_WAIT_LPM_BITS  LPM0_bits
+#endif
+
 //==================================================================================================
 // Struct Typedefs
 //==================================================================================================
 
-// FIFO object
+// FIFO usage counters. See fifo_get_stats()
 typedef struct {
+    size_t high_water;  // most bytes ever stored in the FIFO at once
+    uint32_t bytes_in;  // total bytes written
+    uint32_t bytes_out; // total bytes read, consumed or cleared
+    uint32_t trampled;  // bytes of unread data overwritten by fifo_write_trample()
+    uint32_t full_time; // time spent full, in fifo_telemetry_time() units
+    uint16_t rejected;  // writes that failed with RES_FULL
+} fifo_stats_t;
+
+// FIFO object
+typedef struct fifo_s {
     uint8_t *bufptr;    // pointer to the buffer array
     size_t bufsize;    // size of buffer
     size_t rdidx;    // points to next address to be read
@@ -63,8 +94,27 @@ typedef struct {
 #if(FIFO_LOG_MAX_USAGE == 1)
     size_t max;
 #endif
+#if(FIFO_TELEMETRY == 1)
+    fifo_stats_t stats;
+    uint32_t full_since;    // fifo_telemetry_time() when the FIFO last became full
+    uint8_t is_full;
+    const char *name;       // set by fifo_register()
+    struct fifo_s *next;    // next FIFO in the registry
+#endif
 } FIFO_t;
 
+// Data segment for fifo_writev() and fifo_readv()
+struct fifo_iov {
+    void *buf;          // pointer to the segment's data
+    size_t len;         // size of the segment in bytes
+};
+
+// Record FIFO object
+typedef struct {
+    FIFO_t fifo;        // underlying byte FIFO
+    size_t elsize;      // size of each record in bytes
+} rfifo_t;
+
 //==================================================================================================
 // Function Prototypes
 //==================================================================================================
@@ -88,6 +138,18 @@ void fifo_init(FIFO_t *fifo, void *bufptr, size_t bufsize);
 **/
 RES_t fifo_write(FIFO_t *fifo, void *src, size_t size);
 
+/**
+* \brief Write several segments of data into the FIFO buffer as one operation
+* \details Space is checked once for the total of all segments. Either all segments are written
+*   back-to-back or none are. No other write can be interleaved between the segments.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] iov Array of segments to be stored
+* \param [in] iovcnt Number of segments in \c iov
+* \retval RES_OK 
+* \retval RES_FULL Not enough space in FIFO for requested write operation
+**/
+RES_t fifo_writev(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt);
+
 /**
 * \brief Write data into the FIFO buffer. Tramples over oldest unread data if necessary.
 * \param [in] fifo Pointer to the #FIFO_t object
@@ -106,6 +168,16 @@ void fifo_write_trample(FIFO_t *fifo, void *src, size_t size);
 **/
 RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size);
 
+/**
+* \brief Read data from the FIFO buffer into several segments as one operation
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] iov Array of segments to be filled. A segment with a \c NULL \c buf discards its data.
+* \param [in] iovcnt Number of segments in \c iov
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+**/
+RES_t fifo_readv(FIFO_t *fifo, const struct fifo_iov *iov, size_t iovcnt);
+
 /**
 * \brief Read as much data from the FIFO buffer as possible
 * \param [in] fifo Pointer to the #FIFO_t object
@@ -115,6 +187,36 @@ RES_t fifo_read(FIFO_t *fifo, void *dst, size_t size);
 **/
 size_t fifo_read_max(FIFO_t *fifo, void *dst, size_t max_size);
 
+/**
+* \brief Read data from the FIFO buffer, sleeping in low-power mode until it arrives
+* \details Whatever data is available is read immediately. While the FIFO is empty, the CPU enters
+*   \c FIFO_WAIT_LPM_BITS. Interrupts are enabled by the same instruction that enters the low-power
+*   mode, so data that arrives right after the FIFO is found empty can not be missed.
+*   
+*   The ISR that writes to the FIFO must wake the CPU using \c __bic_SR_register_on_exit(). So that
+*   other code sleeping in low-power mode isn't woken by every write, set a flag around the call to
+*   fifo_read_wait() and only wake the CPU from the ISR while it is set.
+*   Interrupts are enabled while the CPU sleeps, and the caller's GIE state is restored on return.
+*   Must never be called from an ISR.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read. A \c NULL pointer discards the data.
+* \param [in] size Number of bytes to be read from the FIFO
+* \param [in] timeout Maximum time to wait, in fifo_wait_time() units. 0 waits forever.
+*   Ignored unless \c FIFO_WAIT_TIMEOUT is set to 1. The timeout is only checked when the CPU wakes,
+*   so the interrupt that advances fifo_wait_time() must also wake the CPU.
+* \return Number of bytes read. Less than \c size if the timeout expired.
+**/
+size_t fifo_read_wait(FIFO_t *fifo, void *dst, size_t size, uint32_t timeout);
+
+#if(FIFO_WAIT_TIMEOUT == 1) || defined(__DOXYGEN__)
+/**
+* \brief Application-provided timestamp for fifo_read_wait() timeouts
+* \details Only used if \c FIFO_WAIT_TIMEOUT is set to 1. It is called with interrupts disabled.
+* \return A free-running 32-bit count (for example, a millisecond tick)
+**/
+uint32_t fifo_wait_time(void);
+#endif
+
 /**
 * \brief Read data from the FIFO buffer without advancing the read pointer
 * \param [in] fifo Pointer to the #FIFO_t object
@@ -125,6 +227,52 @@ size_t fifo_read_max(FIFO_t *fifo, void *dst, size_t max_size);
 **/
 RES_t fifo_peek(FIFO_t *fifo, void *dst, size_t size);
 
+/**
+* \brief Reserve a contiguous region of the FIFO buffer to be written in-place
+* \details Returns a pointer into the FIFO's buffer at the current write position. The data written
+*   there does not become readable until it is published using fifo_write_commit(). Since the region
+*   is never wrapped, fewer bytes than are reported by fifo_wrcount() may be available. Once the
+*   first span is committed, a second call may return the remaining space at the start of the buffer.
+*   
+*   The region is not claimed until it is committed. Between the reserve and the commit, nothing else
+*   may write to the FIFO (including ISRs that call fifo_write()). Otherwise the other write lands in
+*   the reserved region and fifo_write_commit() publishes it in place of the caller's data. Only use
+*   reserve/commit on a FIFO that has no other producer.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] size Number of contiguous bytes that can be written at the returned pointer
+* \return Pointer to the reserved region
+**/
+void *fifo_write_reserve(FIFO_t *fifo, size_t *size);
+
+/**
+* \brief Publish data that was written in-place after a call to fifo_write_reserve()
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] size Number of bytes to publish
+* \retval RES_OK 
+* \retval RES_PARAMERR \c size is larger than the contiguous region that was reserved
+**/
+RES_t fifo_write_commit(FIFO_t *fifo, size_t size);
+
+/**
+* \brief Get a pointer to the contiguous readable data at the front of the FIFO
+* \details The data can be parsed in-place and then released using fifo_read_consume(). Since the
+*   region is never wrapped, fewer bytes than are reported by fifo_rdcount() may be available.
+*   Likewise, nothing else may read from the FIFO until the data is consumed.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] size Number of contiguous bytes that can be read at the returned pointer
+* \return Pointer to the oldest unread byte in the FIFO
+**/
+void *fifo_read_peek_contig(FIFO_t *fifo, size_t *size);
+
+/**
+* \brief Release data from the front of the FIFO without copying it
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] size Number of bytes to discard
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested operation
+**/
+RES_t fifo_read_consume(FIFO_t *fifo, size_t size);
+
 /**
 * \brief Empties the FIFO
 * \param [in] fifo Pointer to the #FIFO_t object
@@ -146,6 +294,187 @@ size_t fifo_rdcount(FIFO_t *fifo); // Returns the number of bytes currently stor
 **/
 size_t fifo_wrcount(FIFO_t *fifo); // Returns the number of bytes free in the FIFO
 
+//==================================================================================================
+// Telemetry Functions
+//==================================================================================================
+/**
+* \name Telemetry Functions
+* \details Only available if \c FIFO_TELEMETRY is set to 1. Otherwise, fifo_register() does nothing so
+*   that modules can register their FIFOs unconditionally. FIFOs created with FIFO_DECLARE() do not
+*   keep any telemetry.
+* \{
+**/
+
+#if(FIFO_TELEMETRY == 1) || defined(__DOXYGEN__)
+/**
+* \brief Adds a FIFO to the list of FIFOs that can be enumerated with fifo_registry_next()
+* \details Registering the same FIFO again only updates its name. A FIFO must be registered after it
+*   is initialized with fifo_init() and must not go out of scope once it is registered.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] name Name to report the FIFO as. The string is not copied.
+* \return Nothing
+**/
+void fifo_register(FIFO_t *fifo, const char *name);
+
+/**
+* \brief Iterates over all registered FIFOs
+* \code
+* FIFO_t *fifo = NULL;
+* while((fifo = fifo_registry_next(fifo)) != NULL){
+*     fifo_get_stats(fifo, &stats);
+*     printf("%s: %u/%u\n", fifo->name, stats.high_water, fifo->bufsize-1);
+* }
+* \endcode
+* \param [in] fifo The previous FIFO returned, or \c NULL to get the first one
+* \return Next registered FIFO. \c NULL if there are no more.
+**/
+FIFO_t *fifo_registry_next(FIFO_t *fifo);
+
+/**
+* \brief Get a consistent snapshot of a FIFO's usage counters
+* \details If the FIFO is currently full, \c full_time includes the time up to this call.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] stats Copy of the counters
+* \return Nothing
+**/
+void fifo_get_stats(FIFO_t *fifo, fifo_stats_t *stats);
+
+/**
+* \brief Resets a FIFO's usage counters
+* \details \c high_water restarts from the number of bytes currently in the FIFO.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \return Nothing
+**/
+void fifo_reset_stats(FIFO_t *fifo);
+
+/**
+* \brief Application-provided timestamp for measuring how long FIFOs are full
+* \details Only used if \c FIFO_TELEMETRY_TIME is set to 1. It is called with interrupts disabled.
+* \return A free-running 32-bit count (for example, a millisecond tick)
+**/
+uint32_t fifo_telemetry_time(void);
+#else
+    #define fifo_register(fifo, name)   ((void)(fifo), (void)(name))
+#endif
+
+///\}
+
+//==================================================================================================
+// Single-Producer/Single-Consumer Functions
+//==================================================================================================
+/**
+* \name Single-Producer/Single-Consumer Functions
+* \details Lock-free alternatives for FIFOs that are written from exactly one context and read from
+*   exactly one other context. Only the producer may call fifo_spsc_write(). Only the consumer may call
+*   fifo_spsc_read() and fifo_spsc_peek(). Interrupts are never disabled, except briefly to
+*   update the counters when \c FIFO_TELEMETRY is set to 1.
+* \{
+**/
+
+/**
+* \brief Write data into the FIFO buffer (producer only)
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] src Pointer to the data to be stored
+* \param [in] size Number of bytes to be written to the FIFO
+* \retval RES_OK 
+* \retval RES_FULL Not enough space in FIFO for requested write operation
+**/
+RES_t fifo_spsc_write(FIFO_t *fifo, void *src, size_t size);
+
+/**
+* \brief Read data from the FIFO buffer (consumer only)
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read. A \c NULL pointer discards the data.
+* \param [in] size Number of bytes to be read from the FIFO
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+**/
+RES_t fifo_spsc_read(FIFO_t *fifo, void *dst, size_t size);
+
+/**
+* \brief Read data from the FIFO buffer without advancing the read pointer (consumer only)
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read.
+* \param [in] size Number of bytes to be read from the FIFO
+* \retval RES_OK 
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+**/
+RES_t fifo_spsc_peek(FIFO_t *fifo, void *dst, size_t size);
+
+/**
+* \brief Get the number of bytes available for read in the FIFO
+* \details The result is exact when called by the consumer. Any other context may see a smaller value.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \return Number of bytes
+**/
+size_t fifo_spsc_rdcount(FIFO_t *fifo);
+
+/**
+* \brief Get the number of bytes that can be written to the FIFO
+* \details The result is exact when called by the producer. Any other context may see a smaller value.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \return Number of bytes
+**/
+size_t fifo_spsc_wrcount(FIFO_t *fifo);
+
+///\}
+
+//==================================================================================================
+// Record FIFO Functions
+//==================================================================================================
+/**
+* \name Record FIFO Functions
+* \details A record FIFO (#rfifo_t) stores fixed-size records in a #FIFO_t. Batches of records are
+*   moved using a single space check and a single atomic block, which is cheaper than pushing each
+*   record with fifo_write().
+* \{
+**/
+
+/**
+* \brief Initializes a new record FIFO
+* \details To hold exactly \c N records, use a buffer of <tt>N*elsize + 1</tt> bytes. Any excess space
+*   that cannot hold a whole record is left unused.
+* \param [in] rfifo Pointer to an empty #rfifo_t object
+* \param [in] bufptr Pointer to the buffer to be used as storage for the FIFO
+* \param [in] bufsize Size of the buffer in bytes
+* \param [in] elsize Size of each record in bytes
+* \return Nothing
+**/
+void rfifo_init(rfifo_t *rfifo, void *bufptr, size_t bufsize, size_t elsize);
+
+/**
+* \brief Write as many records into the FIFO as possible
+* \param [in] rfifo Pointer to the #rfifo_t object
+* \param [in] src Pointer to an array of records to be stored
+* \param [in] count Maximum number of records to be written
+* \return Number of records written
+**/
+size_t rfifo_push_n(rfifo_t *rfifo, void *src, size_t count);
+
+/**
+* \brief Read as many records from the FIFO as possible
+* \param [in] rfifo Pointer to the #rfifo_t object
+* \param [out] dst Destination array for the records. A \c NULL pointer discards the records.
+* \param [in] count Maximum number of records to be read
+* \return Number of records read
+**/
+size_t rfifo_pop_n(rfifo_t *rfifo, void *dst, size_t count);
+
+/**
+* \brief Get the number of records available for read in the FIFO
+* \param [in] rfifo Pointer to the #rfifo_t object
+* \return Number of records
+**/
+size_t rfifo_rdcount(rfifo_t *rfifo);
+
+/**
+* \brief Get the number of records that can be written to the FIFO
+* \param [in] rfifo Pointer to the #rfifo_t object
+* \return Number of records
+**/
+size_t rfifo_wrcount(rfifo_t *rfifo);
+
+///\}
 
 #ifdef __cplusplus
 }
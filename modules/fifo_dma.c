@@ -0,0 +1,240 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_FIFO_DMA
+* \{
+**/
+
+/**
+* \file
+* \brief Code for \ref MOD_FIFO_DMA
+* \author Alex Mykyta 
+**/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <msp430_xc.h>
+#include <result.h>
+#include <atomic.h>
+
+#include "fifo.h"
+#include "fifo_dma.h"
+#include "fifo_dma_internal.h"
+
+#if(FIFO_DMA_USE_EVENTS == 1)
+    #include "event_queue.h"
+#endif
+
+//==================================================================================================
+// Internal Variables
+//==================================================================================================
+
+// State of the transfer in progress
+static struct {
+    FIFO_t *fifo;
+    uint8_t *next_addr;     // user buffer address of the second segment
+    size_t next_size;       // size of the second segment. 0 if there is none
+    size_t new_idx;         // FIFO index to publish once the transfer is complete
+    bool is_write;
+    void (*callback)(void);
+} xfer;
+
+static volatile bool busy = false;
+
+//==================================================================================================
+// Internal Functions
+//==================================================================================================
+
+// Starts a software-triggered burst-block transfer. The CPU keeps running in between bursts.
+static void start_block(const void *src, void *dst, size_t size){
+    FDMA_CTL = 0;
+    FDMA_TRG &= ~FDMA_TSEL_MASK;
+    FDMA_SA = (uintptr_t)src;
+    FDMA_DA = (uintptr_t)dst;
+    FDMA_SZ = size;
+    FDMA_CTL = DMADT_2 | DMADSTINCR_3 | DMASRCINCR_3 | DMASRCBYTE | DMADSTBYTE | DMAEN | DMAIE;
+    FDMA_CTL |= DMAREQ;
+}
+
+//--------------------------------------------------------------------------------------------------
+static void complete(void (*callback)(void)){
+    if(callback){
+        #if(FIFO_DMA_USE_EVENTS == 1)
+            event_PushEvent(callback, NULL, 0);
+        #else
+            callback();
+        #endif
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Splits a transfer at the FIFO's wrap point. idx is the FIFO index the transfer starts at.
+// Returns the size of the first segment and sets up xfer for the second one.
+static size_t split(FIFO_t *fifo, size_t idx, size_t size){
+    size_t first;
+    
+    first = fifo->bufsize - idx;
+    if(first > size){
+        first = size;
+    }
+    xfer.next_size = size - first;
+    
+    xfer.new_idx = idx + size;
+    if(xfer.new_idx >= fifo->bufsize){
+        xfer.new_idx -= fifo->bufsize;
+    }
+    
+    return(first);
+}
+
+//==================================================================================================
+// Functions
+//==================================================================================================
+RES_t fifo_dma_write(FIFO_t *fifo, const void *src, size_t size, void (*callback)(void)){
+    size_t wridx;
+    size_t first;
+    
+    if(size < FIFO_DMA_THRESHOLD){
+        // A copy into the FIFO would be lost when a DMA transfer in progress publishes its index
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(busy){
+                return(RES_BUSY);
+            }
+            if(fifo_write(fifo, (void*)src, size) != RES_OK){
+                return(RES_FULL);
+            }
+        }
+        complete(callback);
+        return(RES_OK);
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(busy){
+            return(RES_BUSY);
+        }
+        if(size > fifo_wrcount(fifo)){
+            return(RES_FULL);
+        }
+        busy = true;
+        wridx = fifo->wridx;
+    }
+    
+    xfer.fifo = fifo;
+    xfer.is_write = true;
+    xfer.callback = callback;
+    first = split(fifo, wridx, size);
+    xfer.next_addr = (uint8_t*)src + first;
+    
+    start_block(src, fifo->bufptr + wridx, first);
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+RES_t fifo_dma_read(FIFO_t *fifo, void *dst, size_t size, void (*callback)(void)){
+    size_t rdidx;
+    size_t first;
+    
+    if(size < FIFO_DMA_THRESHOLD){
+        // Same as for writes. Don't hand out bytes that a DMA read in progress is also reading
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+            if(busy){
+                return(RES_BUSY);
+            }
+            if(fifo_read(fifo, dst, size) != RES_OK){
+                return(RES_PARAMERR);
+            }
+        }
+        complete(callback);
+        return(RES_OK);
+    }
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
+        if(busy){
+            return(RES_BUSY);
+        }
+        if(size > fifo_rdcount(fifo)){
+            return(RES_PARAMERR);
+        }
+        busy = true;
+        rdidx = fifo->rdidx;
+    }
+    
+    xfer.fifo = fifo;
+    xfer.is_write = false;
+    xfer.callback = callback;
+    first = split(fifo, rdidx, size);
+    xfer.next_addr = (uint8_t*)dst + first;
+    
+    start_block(fifo->bufptr + rdidx, dst, first);
+    
+    return(RES_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool fifo_dma_busy(void){
+    return(busy);
+}
+
+//--------------------------------------------------------------------------------------------------
+bool is_fifo_dma_isr(void){
+    return(FDMA_CTL & DMAIFG);
+}
+
+//--------------------------------------------------------------------------------------------------
+void fifo_dma_isr(void){
+    size_t size;
+    
+    FDMA_CTL &= ~DMAIFG;
+    
+    if(xfer.next_size){
+        // Transfer the segment that wrapped around to the start of the FIFO's buffer
+        size = xfer.next_size;
+        xfer.next_size = 0;
+        if(xfer.is_write){
+            start_block(xfer.next_addr, xfer.fifo->bufptr, size);
+        }else{
+            start_block(xfer.fifo->bufptr, xfer.next_addr, size);
+        }
+        return;
+    }
+    
+    // Publish the transfer
+    FDMA_CTL = 0;
+    if(xfer.is_write){
+        xfer.fifo->wridx = xfer.new_idx;
+    }else{
+        xfer.fifo->rdidx = xfer.new_idx;
+    }
+    busy = false;
+    
+    complete(xfer.callback);
+}
+
+///\}
@@ -0,0 +1,139 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_FIFO_DMA FIFO DMA Transfers
+* \brief Moves bulk data into and out of a #FIFO_t using the DMA controller
+* \author Alex Mykyta 
+*
+* Large transfers are split at the FIFO's wrap point into at most two burst-block DMA transfers. The
+* CPU keeps running between bursts. Once the transfer is complete, the FIFO's index is updated and
+* the completion callback is run. Transfers smaller than \c FIFO_DMA_THRESHOLD are copied using
+* memcpy() and complete immediately.
+*
+* Only one transfer can be in progress at a time. This includes transfers below the threshold, which
+* also return \c RES_BUSY while a DMA transfer is running. While a fifo_dma_write() is in progress, no other
+* writes to that FIFO are allowed. While a fifo_dma_read() is in progress, no other reads from that
+* FIFO are allowed. The other side of the FIFO can be used as usual.
+*
+* DMA transfers are not counted by the \ref MOD_FIFO telemetry.
+*
+* ### MSP430 Processor Families Supported: ###
+*   Family  | Supported
+*   ------- | ----------
+*   1xx     | Yes
+*   2xx     | Yes
+*   4xx     | Yes
+*   5xx     | Yes
+*   6xx     | Yes
+* 
+* \{
+**/
+
+/**
+* \file
+* \brief Include file for \ref MOD_FIFO_DMA
+* \author Alex Mykyta 
+**/
+
+#ifndef FIFO_DMA_H
+#define FIFO_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <result.h>
+
+#include "fifo.h"
+
+//==================================================================================================
+// Function Prototypes
+//==================================================================================================
+
+/**
+* \brief Write data into a FIFO in the background
+* \details The data becomes readable all at once when the transfer completes. \c src must remain
+*   valid until then.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [in] src Pointer to the data to be stored
+* \param [in] size Number of bytes to be written to the FIFO
+* \param [in] callback Function to call once the transfer is complete. Can be \c NULL.
+* \retval RES_OK Transfer started (or already completed if it was below the threshold)
+* \retval RES_FULL Not enough space in FIFO for requested write operation
+* \retval RES_BUSY Another transfer is still in progress
+**/
+RES_t fifo_dma_write(FIFO_t *fifo, const void *src, size_t size, void (*callback)(void));
+
+/**
+* \brief Read data from a FIFO in the background
+* \details The space is released to writers all at once when the transfer completes.
+* \param [in] fifo Pointer to the #FIFO_t object
+* \param [out] dst Destination of the data to be read
+* \param [in] size Number of bytes to be read from the FIFO
+* \param [in] callback Function to call once the transfer is complete. Can be \c NULL.
+* \retval RES_OK Transfer started (or already completed if it was below the threshold)
+* \retval RES_PARAMERR Not enough bytes written in FIFO for requested read operation
+* \retval RES_BUSY Another transfer is still in progress
+**/
+RES_t fifo_dma_read(FIFO_t *fifo, void *dst, size_t size, void (*callback)(void));
+
+/**
+* \brief Check if a transfer is in progress
+* \retval true A transfer is in progress
+* \retval false The DMA channel is idle
+**/
+bool fifo_dma_busy(void);
+
+/**
+* \brief FIFO DMA Interrupt Service Routine
+* \details The user must implement the DMA controller's ISR function. The ISR must call this function
+* if the interrupt is for the FIFO DMA channel. This can be done using the is_fifo_dma_isr() function
+* as follows:
+* \code
+*   if(is_fifo_dma_isr()){
+*       fifo_dma_isr();
+*   }
+* \endcode
+* If \c FIFO_DMA_USE_EVENTS is enabled, the ISR should end with EVENT_WAKE_ON_EXIT().
+**/
+void fifo_dma_isr(void);
+
+/**
+* \brief Test to check if the current DMA ISR is for the FIFO DMA channel
+* \retval true  Interrupt flag corresponding to the FIFO DMA channel is set.
+* \retval false FIFO DMA interrupt flag is not set.
+**/
+bool is_fifo_dma_isr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+///\}
@@ -0,0 +1,4 @@
+
+########################################### Module Setup ###########################################
+MODULE_SOURCES += fifo_dma.c
+REQUIRED_MODULES += fifo
@@ -0,0 +1,36 @@
+/**
+* \addtogroup MOD_FIFO_DMA
+* \{
+**/
+
+/**
+* \file
+* \brief Configuration include file for \ref MOD_FIFO_DMA
+* \author Alex Mykyta 
+**/
+
+#ifndef FIFO_DMA_CONFIG_H
+#define FIFO_DMA_CONFIG_H
+
+//==================================================================================================
+/// \name Configuration
+/// Configuration defines for the \ref MOD_FIFO_DMA module
+/// \{
+//==================================================================================================
+
+/// DMA channel used for FIFO transfers
+#define FIFO_DMA_CHANNEL    1    ///< \hideinitializer
+
+/// Transfers smaller than this many bytes are copied using memcpy() instead of DMA
+#define FIFO_DMA_THRESHOLD  32    ///< \hideinitializer
+
+/// Select how the completion callback is run
+#define FIFO_DMA_USE_EVENTS 0    ///< \hideinitializer
+/**<    0 = The callback is called directly from the DMA ISR \n
+*       1 = The callback is queued using event_PushEvent(). Requires the \ref MOD_EVENT_QUEUE module.
+**/
+
+///\}
+    
+#endif
+///\}
@@ -0,0 +1,102 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FIFO_DMA_INTERNAL_H
+#define FIFO_DMA_INTERNAL_H
+
+#include <fifo_dma_config.h>
+
+//==================================================================================================
+// DMA Controller Selection
+//==================================================================================================
+
+// Check if requested DMA channel exists
+#if defined(__MSP430_HAS_DMA_1__)
+    #if(FIFO_DMA_CHANNEL > 0)
+        #error The selected FIFO_DMA_CHANNEL is invalid
+    #endif
+#elif defined(__MSP430_HAS_DMA_3__)
+    #if(FIFO_DMA_CHANNEL > 2)
+        #error The selected FIFO_DMA_CHANNEL is invalid
+    #endif
+#elif defined(__MSP430_HAS_DMAX_3__)
+    #if(FIFO_DMA_CHANNEL > 2)
+        #error The selected FIFO_DMA_CHANNEL is invalid
+    #endif
+#elif defined(__MSP430_HAS_DMAX_6__)
+    #if(FIFO_DMA_CHANNEL > 5)
+        #error The selected FIFO_DMA_CHANNEL is invalid
+    #endif
+#else
+    #error "Device does not have a DMA controller"
+#endif
+
+#define _TPASTE3(a,b,c)  a##b##c
+#define TPASTE3(a,b,c)  _TPASTE3(a,b,c)
+
+// Registers
+#define FDMA_CTL        TPASTE3(DMA, FIFO_DMA_CHANNEL, CTL)
+#define FDMA_SA         TPASTE3(DMA, FIFO_DMA_CHANNEL, SA)
+#define FDMA_DA         TPASTE3(DMA, FIFO_DMA_CHANNEL, DA)
+#define FDMA_SZ         TPASTE3(DMA, FIFO_DMA_CHANNEL, SZ)
+
+// Determine Trigger control register and corresponding mask.
+// The FIFO DMA channel always uses trigger 0 (DMAREQ software trigger)
+#if defined(__MSP430_HAS_DMA_1__)
+    #define FDMA_TRG            DMACTL0
+    #define FDMA_TSEL_MASK      0x000F
+#elif defined(__MSP430_HAS_DMA_3__) || defined(__MSP430_HAS_DMAX_3__)    
+    #define FDMA_TRG            DMACTL0
+    
+    #if(FIFO_DMA_CHANNEL == 0)
+        #define FDMA_TSEL_MASK      0x000F
+    #elif(FIFO_DMA_CHANNEL == 1)
+        #define FDMA_TSEL_MASK      0x00F0
+    #elif(FIFO_DMA_CHANNEL == 2)
+        #define FDMA_TSEL_MASK      0x0F00
+    #endif
+#elif defined(__MSP430_HAS_DMAX_6__)
+    #if(FIFO_DMA_CHANNEL == 0)
+        #define FDMA_TRG            DMACTL0
+        #define FDMA_TSEL_MASK      0x001F
+    #elif(FIFO_DMA_CHANNEL == 1)
+        #define FDMA_TRG            DMACTL0
+        #define FDMA_TSEL_MASK      0x1F00
+    #elif(FIFO_DMA_CHANNEL == 2)
+        #define FDMA_TRG            DMACTL1
+        #define FDMA_TSEL_MASK      0x001F
+    #elif(FIFO_DMA_CHANNEL == 3)
+        #define FDMA_TRG            DMACTL1
+        #define FDMA_TSEL_MASK      0x1F00
+    #elif(FIFO_DMA_CHANNEL == 4)
+        #define FDMA_TRG            DMACTL2
+        #define FDMA_TSEL_MASK      0x001F
+    #elif(FIFO_DMA_CHANNEL == 5)
+        #define FDMA_TRG            DMACTL2
+        #define FDMA_TSEL_MASK      0x1F00
+    #endif
+#endif
+
+#endif
@@ -0,0 +1,255 @@
+/*
+* Copyright (c) 2014, Alexander I. Mykyta
+* All rights reserved.
+* 
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met: 
+* 
+* 1. Redistributions of source code must retain the above copyright notice, this
+*    list of conditions and the following disclaimer. 
+* 2. Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution. 
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+* \addtogroup MOD_FIFO
+* \{
+**/
+
+/**
+* \file
+* \brief Statically sized power-of-two FIFO for \ref MOD_FIFO
+* \author Alex Mykyta 
+* 
+* FIFO_DECLARE() generates a FIFO object with a fixed power-of-two size along with a set of inline
+* access functions. Since the size is known at compile time, wrapping is done by masking a pair of
+* free-running indexes, so the compares, subtractions and wrap branches of the generic #FIFO_t go away.
+* Unlike #FIFO_t, every byte of the buffer can be used.
+* 
+* The generated functions mirror the generic \c fifo_* functions, minus the FIFO pointer argument.
+* They are interrupt-safe in the same way.
+* 
+* \c examples/fifo_bench measures the cycles per call of both on a target.
+* 
+* \code
+*     FIFO_DECLARE(MyFIFO, 64)
+*     
+*     MyFIFO_init();
+*     MyFIFO_write(&data, sizeof(data));   // Same as fifo_write()
+*     MyFIFO_push(0x55);                   // Single byte
+*     MyFIFO_push16(0x1234);               // Single word
+* \endcode
+* 
+* The following functions are generated for a FIFO named \c name:
+*   - <tt>void name_init(void)</tt>
+*   - <tt>RES_t name_write(void *src, size_t size)</tt>
+*   - <tt>RES_t name_writev(const struct fifo_iov *iov, size_t iovcnt)</tt>
+*   - <tt>RES_t name_read(void *dst, size_t size)</tt>
+*   - <tt>RES_t name_peek(void *dst, size_t size)</tt>
+*   - <tt>void name_clear(void)</tt>
+*   - <tt>size_t name_rdcount(void)</tt>
+*   - <tt>size_t name_wrcount(void)</tt>
+*   - <tt>RES_t name_push(uint8_t b)</tt>
+*   - <tt>RES_t name_pop(uint8_t *b)</tt>
+*   - <tt>RES_t name_push16(uint16_t w)</tt>
+*   - <tt>RES_t name_pop16(uint16_t *w)</tt>
+**/
+
+#ifndef FIFO_POW2_H
+#define FIFO_POW2_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <result.h>
+#include <atomic.h>
+
+#include <fifo.h>
+
+///\cond INTERNAL
+// Copies data into the buffer at the masked write index. Returns the new free-running index.
+static inline size_t fifo_pow2_copy_in(uint8_t *buf, size_t mask, size_t wridx, const void *src, size_t size){
+    size_t offset = wridx & mask;
+    size_t first = mask + 1 - offset;
+    
+    if(first >= size){
+        memcpy(buf + offset, src, size);
+    }else{
+        memcpy(buf + offset, src, first);
+        memcpy(buf, (const uint8_t*)src + first, size - first);
+    }
+    return(wridx + size);
+}
+
+// Copies data out of the buffer at the masked read index. A NULL dst discards the data.
+// Returns the new free-running index.
+static inline size_t fifo_pow2_copy_out(const uint8_t *buf, size_t mask, size_t rdidx, void *dst, size_t size){
+    size_t offset = rdidx & mask;
+    size_t first = mask + 1 - offset;
+    
+    if(dst != NULL){
+        if(first >= size){
+            memcpy(dst, buf + offset, size);
+        }else{
+            memcpy(dst, buf + offset, first);
+            memcpy((uint8_t*)dst + first, buf, size - first);
+        }
+    }
+    return(rdidx + size);
+}
+///\endcond
+
+/**
+* \brief Declares a statically sized FIFO and its access functions
+* \param name Name of the FIFO object. Also used as the prefix of the generated functions.
+* \param size Size of the FIFO in bytes. Must be a power of two.
+* \hideinitializer
+**/
+#define FIFO_DECLARE(name, size) \
+    typedef char name##_size_must_be_pow2[(((size) > 0) && (((size) & ((size)-1)) == 0)) ? 1 : -1]; \
+    static struct { \
+        uint8_t buf[size]; \
+        size_t rdidx; \
+        size_t wridx; \
+    } name; \
+    \
+    static inline void name##_init(void){ \
+        name.rdidx = 0; \
+        name.wridx = 0; \
+    } \
+    \
+    static inline void name##_clear(void){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            name.rdidx = name.wridx; \
+        } \
+    } \
+    \
+    static inline size_t name##_rdcount(void){ \
+        size_t count; \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            count = name.wridx - name.rdidx; \
+        } \
+        return(count); \
+    } \
+    \
+    static inline size_t name##_wrcount(void){ \
+        return((size) - name##_rdcount()); \
+    } \
+    \
+    static inline RES_t name##_write(void *src, size_t n){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(n > (size) - (name.wridx - name.rdidx)){ \
+                return(RES_FULL); \
+            } \
+            name.wridx = fifo_pow2_copy_in(name.buf, (size)-1, name.wridx, src, n); \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_writev(const struct fifo_iov *iov, size_t iovcnt){ \
+        size_t total = 0; \
+        size_t i; \
+        for(i=0; i<iovcnt; i++){ \
+            total += iov[i].len; \
+        } \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(total > (size) - (name.wridx - name.rdidx)){ \
+                return(RES_FULL); \
+            } \
+            for(i=0; i<iovcnt; i++){ \
+                if(iov[i].len){ \
+                    name.wridx = fifo_pow2_copy_in(name.buf, (size)-1, name.wridx, iov[i].buf, iov[i].len); \
+                } \
+            } \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_read(void *dst, size_t n){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(n > name.wridx - name.rdidx){ \
+                return(RES_PARAMERR); \
+            } \
+            name.rdidx = fifo_pow2_copy_out(name.buf, (size)-1, name.rdidx, dst, n); \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_peek(void *dst, size_t n){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(n > name.wridx - name.rdidx){ \
+                return(RES_PARAMERR); \
+            } \
+            fifo_pow2_copy_out(name.buf, (size)-1, name.rdidx, dst, n); \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_push(uint8_t b){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(name.wridx - name.rdidx == (size)){ \
+                return(RES_FULL); \
+            } \
+            name.buf[name.wridx & ((size)-1)] = b; \
+            name.wridx++; \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_pop(uint8_t *b){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(name.wridx == name.rdidx){ \
+                return(RES_PARAMERR); \
+            } \
+            *b = name.buf[name.rdidx & ((size)-1)]; \
+            name.rdidx++; \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_push16(uint16_t w){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if((size) - (name.wridx - name.rdidx) < 2){ \
+                return(RES_FULL); \
+            } \
+            name.buf[name.wridx & ((size)-1)] = (uint8_t)w; \
+            name.buf[(name.wridx+1) & ((size)-1)] = (uint8_t)(w >> 8); \
+            name.wridx += 2; \
+        } \
+        return(RES_OK); \
+    } \
+    \
+    static inline RES_t name##_pop16(uint16_t *w){ \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE){ \
+            if(name.wridx - name.rdidx < 2){ \
+                return(RES_PARAMERR); \
+            } \
+            *w = name.buf[name.rdidx & ((size)-1)]; \
+            *w |= (uint16_t)name.buf[(name.rdidx+1) & ((size)-1)] << 8; \
+            name.rdidx += 2; \
+        } \
+        return(RES_OK); \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+///\}
@@ -59,6 +59,9 @@
 static timer_t *tmr_first;
 static uint16_t prev_tr = 0;
 
+// Ticks until an expiration is pushed again if the event queue was full (about 1 ms)
+#define TMR_RETRY_TICKS     ((TMR_FCLKDIV/1000) + 1)
+
 typedef struct{
     void *ev_data;
     void (*fptr)(void*);
@@ -97,9 +100,14 @@ static uint32_t RefreshTimers(uint16_t current_tr){
                 dat.fptr = tmr->fptr;
                 
                 // Push event
-                event_PushEvent(timer_event_wrapper, &dat, sizeof(dat));
-                
-                if(tmr->ticks_reload){
+                if(event_PushEvent(timer_event_wrapper, &dat, sizeof(dat)) != RES_OK){
+                    // The event queue is full. Keep the timer in the list and try again shortly
+                    // rather than losing the expiration.
+                    tmr->ticks_remaining = TMR_RETRY_TICKS;
+                    if(tmr->ticks_remaining < ticks_min){
+                        ticks_min = tmr->ticks_remaining;
+                    }
+                }else if(tmr->ticks_reload){
                     // Timer repeats. Reload it
                     tmr->ticks_remaining = tmr->ticks_reload;
                     if((tmr->ticks_remaining < ticks_min) || (tmr->ticks_remaining == 0)){
@@ -171,11 +179,7 @@ ISR(TMR_TIMER_ISR_VECTOR){
         }
     }
     
-    if(event_Pending()){
-        // Exit LPM0-3
-        __bic_SR_register_on_exit(LPM3_bits);
-        __no_operation();
-    }
+    EVENT_WAKE_ON_EXIT();
 }
 //--------------------------------------------------------------------------------------------------
 void timer_init(void){
@@ -205,7 +209,7 @@ void timer_uninit(void){
 }
 
 //--------------------------------------------------------------------------------------------------
-void timer_start(timer_t *timerid, struct timerctl *settings){
+RES_t timer_start(timer_t *timerid, struct timerctl *settings){
     
     // If the timer is already running, stop it.
     timer_stop(timerid);
@@ -213,8 +217,8 @@ void timer_start(timer_t *timerid, struct timerctl *settings){
     if(settings){
         // New timer settings.
         
-        if(settings->interval_ms < TMR_INTERVAL_MIN) return;
-        if(settings->interval_ms > TMR_INTERVAL_MAX) return;
+        if(settings->interval_ms < TMR_INTERVAL_MIN) return(RES_PARAMERR);
+        if(settings->interval_ms > TMR_INTERVAL_MAX) return(RES_PARAMERR);
         
         
         // calculate the interval in ticks
@@ -233,7 +237,7 @@ void timer_start(timer_t *timerid, struct timerctl *settings){
     }
     
     if((timerid->ticks_remaining == 0) && (timerid->ticks_reload == 0)){
-        return;
+        return(RES_OK);
     }
     
     // disable timer interrupt
@@ -259,7 +263,7 @@ void timer_start(timer_t *timerid, struct timerctl *settings){
     
     if(ticks_min == 0xFFFFFFFFL){
         // no timers active. Leave interrupt disabled
-        return;
+        return(RES_OK);
     }else if(ticks_min < 0x10000){
         TMR_TCCR0 = current_tr + ticks_min;
     }else{
@@ -268,6 +272,8 @@ void timer_start(timer_t *timerid, struct timerctl *settings){
     
     // Enable timer interrupt
     TMR_TCCTL0 |= CCIE;
+    
+    return(RES_OK);
 }
 
 //--------------------------------------------------------------------------------------------------
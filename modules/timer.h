@@ -48,6 +48,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <result.h>
 
 #include <timer_config.h>
 
@@ -100,11 +101,17 @@ void timer_uninit(void);
  * operates. A prevoiously stopped timer can be resumed by passing a NULL pointer into the 
  * \c settings argument.
  * 
+ * If the event queue is full when the timer expires, the expiration is pushed again about 1 ms
+ * later instead of being lost. The next period of a repeating timer starts once it was pushed.
+ * 
  * \param timerid Pointer to the timer object
  * \param settings Pointer to a \ref timerctl struct which defines the behavior of a new timer.
  *     A NULL pointer will resume a previously stopped timer defined by \c timerid
+ * \retval RES_OK    Timer started
+ * \retval RES_PARAMERR    \c interval_ms is outside of the range the timer can count. The timer is
+ *     left stopped.
  **/
-void timer_start(timer_t *timerid, struct timerctl *settings);
+RES_t timer_start(timer_t *timerid, struct timerctl *settings);
 
 /**
  * \brief Stops a currently running timer
@@ -58,12 +58,31 @@
 #include "uart_io_internal.h"
 
 #if((UIO_RX_MODE == 1) || (UIO_TX_MODE == 1)) // Interrupt Mode
-    #include "fifo.h"
+    #if(UIO_FIFO_POW2 == 1)
+        #include "fifo_pow2.h"
+    #else
+        #include "fifo.h"
+    #endif
 #endif
 
+// In interrupt mode, the FIFOs are accessed through the function names generated by FIFO_DECLARE().
+// When using the generic FIFO, these map onto the equivalent fifo_* calls.
 #if(UIO_RX_MODE == 1) // Interrupt Mode
-    static char rxbuf[UIO_RXBUF_SIZE];
-    static FIFO_t RXFIFO;
+    #if(UIO_FIFO_POW2 == 1)
+        FIFO_DECLARE(RXFIFO, UIO_RXBUF_SIZE)
+    #else
+        static char rxbuf[UIO_RXBUF_SIZE];
+        static FIFO_t RXFIFO;
+        #define RXFIFO_init()           do{ fifo_init(&RXFIFO, rxbuf, UIO_RXBUF_SIZE); \
+                                    fifo_register(&RXFIFO, "uart_rx"); }while(0)
+        #define RXFIFO_read(dst, n)     fifo_read(&RXFIFO, dst, n)
+        #define RXFIFO_rdcount()        fifo_rdcount(&RXFIFO)
+        #define RXFIFO_clear()          fifo_clear(&RXFIFO)
+        #define RXFIFO_push(b)          fifo_write(&RXFIFO, &(uint8_t){b}, 1)
+    #endif
+    
+    // Set while uart_read() is waiting for data, so that the RX ISR only wakes the CPU when needed
+    static volatile bool rx_waiting;
 #elif(UIO_RX_MODE == 2) // DMA Mode
     static char rxbuf[UIO_RXBUF_SIZE];
     static volatile int8_t rx_laplead;
@@ -71,8 +90,17 @@
 #endif
 
 #if(UIO_TX_MODE == 1) // Interrupt Mode
-    static char txbuf[UIO_TXBUF_SIZE];
-    static FIFO_t TXFIFO;
+    #if(UIO_FIFO_POW2 == 1)
+        FIFO_DECLARE(TXFIFO, UIO_TXBUF_SIZE)
+    #else
+        static char txbuf[UIO_TXBUF_SIZE];
+        static FIFO_t TXFIFO;
+        #define TXFIFO_init()           do{ fifo_init(&TXFIFO, txbuf, UIO_TXBUF_SIZE); \
+                                    fifo_register(&TXFIFO, "uart_tx"); }while(0)
+        #define TXFIFO_write(src, n)    fifo_write(&TXFIFO, src, n)
+        #define TXFIFO_wrcount()        fifo_wrcount(&TXFIFO)
+        #define TXFIFO_pop(b)           fifo_read(&TXFIFO, b, 1)
+    #endif
 #elif(UIO_TX_MODE == 2) // DMA Mode
     #error DMA TX mode not supported yet.
 #endif
@@ -92,12 +120,12 @@ void uart_init(void){
         UIO_CTL  &= ~SWRST;
         
         #if(UIO_RX_MODE == 1) // Interrupt Mode
-            fifo_init(&RXFIFO, rxbuf, UIO_RXBUF_SIZE);
+            RXFIFO_init();
             UIO_IE |= UIO_RXIE;
         #endif
         
         #if(UIO_TX_MODE == 1) // Interrupt Mode
-            fifo_init(&TXFIFO, txbuf, UIO_TXBUF_SIZE);
+            TXFIFO_init();
         #endif
         
     #elif defined(__MSP430_HAS_2xx_USCI__) || defined(__MSP430_HAS_5xx_USCI__) || defined(__MSP430_HAS_6xx_EUSCI__)
@@ -110,12 +138,12 @@ void uart_init(void){
         UIO_CTL1 &= ~UCSWRST;
         
         #if(UIO_RX_MODE == 1) // Interrupt Mode
-            fifo_init(&RXFIFO, rxbuf, UIO_RXBUF_SIZE);
+            RXFIFO_init();
             UIO_IE |= UIO_RXIE;
         #endif
         
         #if(UIO_TX_MODE == 1) // Interrupt Mode
-            fifo_init(&TXFIFO, txbuf, UIO_TXBUF_SIZE);
+            TXFIFO_init();
         #endif   
     #endif
     
@@ -157,25 +185,43 @@ void uart_uninit(void){
 // RX Functions
 //==================================================================================================
 void uart_read(void *buf, size_t size){
-    #if (UIO_RX_MODE == 1) // Interrupt Mode
+    #if (UIO_RX_MODE == 1) && (UIO_FIFO_POW2 == 0) // Interrupt Mode
+        // Sleeps until the RX ISR has received everything
+        rx_waiting = true;
+        fifo_read_wait(&RXFIFO, buf, size, 0);
+        rx_waiting = false;
+    #elif (UIO_RX_MODE == 1) // Interrupt Mode
         size_t rdcount;
         uint8_t* u8buf = (uint8_t*)buf;
         
         while(size > 0){
             // Get number of bytes that can be read.
-            rdcount = fifo_rdcount(&RXFIFO);
+            rdcount = RXFIFO_rdcount();
             if(rdcount > size){
                 rdcount = size;
             }
             
             if(rdcount != 0){
                 if(u8buf){
-                    fifo_read(&RXFIFO, u8buf, rdcount);
+                    RXFIFO_read(u8buf, rdcount);
                     u8buf += rdcount;
                 }else{
-                    fifo_read(&RXFIFO, NULL, rdcount);
+                    RXFIFO_read(NULL, rdcount);
                 }
                 size -= rdcount;
+            }else{
+                // Sleep until the RX ISR wakes the CPU. GIE is set in the same instruction that
+                // enters LPM so that a byte arriving after the check can't be missed.
+                __disable_interrupt();
+                __no_operation();
+                if(RXFIFO_rdcount() == 0){
+                    rx_waiting = true;
+                    __bis_SR_register(FIFO_WAIT_LPM_BITS | GIE);
+                    __no_operation();
+                    rx_waiting = false;
+                }else{
+                    __enable_interrupt();
+                }
             }
         }
     #elif (UIO_RX_MODE == 2) // DMA Mode
@@ -264,7 +310,7 @@ void uart_read(void *buf, size_t size){
 //--------------------------------------------------------------------------------------------------
 size_t uart_rdcount(void){
     #if (UIO_RX_MODE == 1) // Interrupt Mode
-        return(fifo_rdcount(&RXFIFO));
+        return(RXFIFO_rdcount());
     #elif (UIO_RX_MODE == 2) // DMA Mode
         int8_t laplead;
         uint16_t wridx;
@@ -306,7 +352,7 @@ size_t uart_rdcount(void){
 //--------------------------------------------------------------------------------------------------
 void uart_rdflush(void){
     #if (UIO_RX_MODE == 1) // Interrupt Mode
-        fifo_clear(&RXFIFO);
+        RXFIFO_clear();
     #elif (UIO_RX_MODE == 2) // DMA Mode
         uint16_t wridx;
         
@@ -371,13 +417,13 @@ void uart_write(void *buf, size_t size){
         
         while(size > 0){
             // Get number of bytes that can be written.
-            wrcount = fifo_wrcount(&TXFIFO);
+            wrcount = TXFIFO_wrcount();
             if(wrcount > size){
                 wrcount = size;
             }
             
             if(wrcount != 0){
-                fifo_write(&TXFIFO, u8buf, wrcount);
+                TXFIFO_write(u8buf, wrcount);
                 u8buf += wrcount;
                 size -= wrcount;
                 // Since TX is inactive and should be empty, the interrupt should occur immediately.
@@ -430,17 +476,20 @@ void uart_puts(char *s){
     #if (UIO_RX_MODE == 1) // Interrupt Mode
         // RX Interrupt Service Routine
         ISR(UIO_RXISR_VECTOR){
-            char chr;
-            chr = UIO_RXBUF;
-            fifo_write(&RXFIFO, &chr, 1);
+            RXFIFO_push(UIO_RXBUF);
+            
+            // Wake up uart_read(). Other code sleeping in LPM is left alone.
+            if(rx_waiting){
+                __bic_SR_register_on_exit(LPM4_bits);
+            }
         }
     #endif
     
     #if (UIO_TX_MODE == 1) // Interrupt Mode
         // TX Interrupt Service Routine
         ISR(UIO_TXISR_VECTOR){
-            char chr;
-            if(fifo_read(&TXFIFO, &chr, 1) == RES_OK){
+            uint8_t chr;
+            if(TXFIFO_pop(&chr) == RES_OK){
                     UIO_TXBUF = chr;
             }else{
                 UIO_IE &= ~UIO_TXIE; // disable tx interrupt
@@ -451,20 +500,23 @@ void uart_puts(char *s){
     #if (UIO_RX_MODE == 1) || (UIO_TX_MODE == 1)
         // RX/TX Interrupt Service Routine
         ISR(UIO_ISR_VECTOR){
-            char chr;
-            
             #if (UIO_RX_MODE == 1)
             if(UIO_IFG & UIO_RXIFG){
                 // Data Recieved
-                chr = UIO_RXBUF;
-                fifo_write(&RXFIFO, &chr, 1);
+                RXFIFO_push(UIO_RXBUF);
+                
+                // Wake up uart_read(). Other code sleeping in LPM is left alone.
+                if(rx_waiting){
+                    __bic_SR_register_on_exit(LPM4_bits);
+                }
             }
             #endif
             
             #if (UIO_TX_MODE == 1)
             if(UIO_IFG & UIO_TXIFG){
                 // Transmit Buffer Empty
-                if(fifo_read(&TXFIFO, &chr, 1) == RES_OK){
+                uint8_t chr;
+                if(TXFIFO_pop(&chr) == RES_OK){
                     UIO_TXBUF = chr;
                 }else{
                     UIO_IE &= ~UIO_TXIE; // disable tx interrupt
@@ -59,6 +59,12 @@
 // Common Settings
 //--------------------------------------------------------------------------------------------------
 
+/// Use the statically sized power-of-two FIFO implementation for the RX and TX buffers
+#define UIO_FIFO_POW2       0    ///< \hideinitializer
+/**<    0 = Generic #FIFO_t (any buffer size) \n
+*       1 = FIFO_DECLARE() FIFO. UIO_RXBUF_SIZE and UIO_TXBUF_SIZE must be powers of two.
+**/
+
 /// Select which USCI/USART module to use
 #define UIO_USE_DEV         0    ///< \hideinitializer
 /**<    0 = USCIA0 \n
@@ -110,7 +110,7 @@ uint8_t USB_handleClockEvent(void){
     uint8_t eventid;
     eventid = USBEV_CLOCKFAULT;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -122,7 +122,7 @@ uint8_t USB_handleVbusOnEvent(void){
     uint8_t eventid;
     eventid = USBEV_VBUSON;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -135,7 +135,7 @@ uint8_t USB_handleVbusOffEvent(void){
     eventid = USBEV_VBUSOFF;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
 
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -148,7 +148,7 @@ uint8_t USB_handleResetEvent(void){
     eventid = USBEV_RESET;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
 
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -161,7 +161,7 @@ uint8_t USB_handleSuspendEvent(void){
     eventid = USBEV_SUSPEND;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
 
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -174,7 +174,7 @@ uint8_t USB_handleResumeEvent(void){
     eventid = USBEV_RESUME;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
 
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -188,7 +188,7 @@ uint8_t USB_handleEnumCompleteEvent(void){
     eventid = USBEV_ENUMERATED;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
 
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -204,7 +204,7 @@ uint8_t USBCDC_handleDataReceived(uint8_t intfNum){
     event_data.intfNum = intfNum;
     event_PushEvent(ev_USB_InterfaceEvent,&event_data,sizeof(EV_DATA_t));
 
-    return TRUE;   //return TRUE to wake the main loop (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -221,7 +221,7 @@ uint8_t USBCDC_handleSendCompleted(uint8_t intfNum){
         event_PushEvent(ev_USB_InterfaceEvent,&event_data,sizeof(EV_DATA_t));
     }
     
-    return TRUE;   //sleep after interrupt (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -237,7 +237,7 @@ uint8_t USBCDC_handleReceiveCompleted(uint8_t intfNum){
         event_PushEvent(ev_USB_InterfaceEvent,&event_data,sizeof(EV_DATA_t));
     }
 
-    return TRUE;   //sleep after interrupt (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -273,7 +273,7 @@ uint8_t USBHID_handleDataReceived(uint8_t intfNum){
     event_data.intfNum = intfNum;
     event_PushEvent(ev_USB_InterfaceEvent,&event_data,sizeof(EV_DATA_t));
 
-    return TRUE;   //sleep after interrupt (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -290,7 +290,7 @@ uint8_t USBHID_handleSendCompleted(uint8_t intfNum){
         event_PushEvent(ev_USB_InterfaceEvent,&event_data,sizeof(EV_DATA_t));
     }
     
-    return TRUE;   //sleep after interrupt (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -306,7 +306,7 @@ uint8_t USBHID_handleReceiveCompleted(uint8_t intfNum){
         event_PushEvent(ev_USB_InterfaceEvent,&event_data,sizeof(EV_DATA_t));
     }
     
-    return TRUE;   //sleep after interrupt (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -360,7 +360,7 @@ uint8_t USBMSC_handleBufferEvent(void){
     uint8_t eventid;
     eventid = USBEV_MSC_BUFFEREVENT;
     event_PushEvent(ev_USB_Event,&eventid,sizeof(uint8_t));
-    return TRUE;    //sleep after interrupt (in the case the CPU slept before interrupt)
+    return(event_Pending()); // wake the main loop if an event is pending
 }
 #endif // _MSC_
 
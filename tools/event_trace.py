@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+Decodes an event queue trace dump (see event_TraceDump() in modules/event_queue.h) into a Chrome
+trace that can be opened in chrome://tracing or https://ui.perfetto.dev
+
+Handler addresses are turned into names using the symbol table of the firmware's ELF file.
+
+Example:
+    event_trace.py trace.bin firmware.elf --tick-hz 32768 -o trace.json
+    event_trace.py trace.bin firmware.elf --tick-hz 32768 --text
+"""
+
+import argparse
+import bisect
+import json
+import struct
+import subprocess
+import sys
+
+REC_NAMES = {
+    1: "push",
+    2: "drop",
+    3: "dispatch",
+    4: "end",
+    5: "yield",
+    6: "idle",
+}
+
+#---------------------------------------------------------------------------------------------------
+def load_symbols(elf, nm):
+    """Returns a sorted list of (address, name) for the functions in the ELF file"""
+    out = subprocess.run([nm, "-C", elf], check=True, stdout=subprocess.PIPE,
+                         universal_newlines=True).stdout
+    syms = []
+    for line in out.splitlines():
+        fields = line.split(None, 2)
+        if (len(fields) == 3) and (fields[1] in "TtWw"):
+            syms.append((int(fields[0], 16), fields[2]))
+    syms.sort()
+    return syms
+
+#---------------------------------------------------------------------------------------------------
+class Symbolizer:
+    def __init__(self, syms):
+        self.addrs = [a for a, _ in syms]
+        self.names = [n for _, n in syms]
+    
+    def __call__(self, addr):
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i < 0:
+            return "0x%x" % addr
+        if self.addrs[i] == addr:
+            return self.names[i]
+        return "%s+0x%x" % (self.names[i], addr - self.addrs[i])
+
+#---------------------------------------------------------------------------------------------------
+def read_dump(data):
+    """
+    Returns a list of (ticks, type, size, queued, addr). ticks is unwrapped to keep increasing.
+    queued is None for version 1 dumps, which did not record it.
+    """
+    if data[0:4] != b"EVTR":
+        raise ValueError("Not an event trace dump (bad magic)")
+    version, rec_size, count = struct.unpack_from("<BBH", data, 4)
+    if version not in (1, 2):
+        raise ValueError("Unsupported trace version %d" % version)
+    
+    records = []
+    ticks = 0
+    prev = None
+    offset = 8
+    for _ in range(count):
+        if offset + rec_size > len(data):
+            raise ValueError("Dump is truncated")
+        if version == 1:
+            time, rtype, size, addr = struct.unpack_from("<HBBI", data, offset)
+            queued = None
+        else:
+            addr, time, rtype, size, queued = struct.unpack_from("<IHBBH", data, offset)
+        offset += rec_size
+        
+        # The timestamps are 16 bits. Assume consecutive records are less than one wrap apart.
+        if prev is not None:
+            ticks += (time - prev) & 0xFFFF
+        prev = time
+        records.append((ticks, rtype, size, queued, addr))
+    return records
+
+#---------------------------------------------------------------------------------------------------
+def to_chrome(records, symbolize, tick_hz):
+    events = []
+    for ticks, rtype, size, queued, addr in records:
+        ev = {
+            "name": symbolize(addr),
+            "ts": ticks * 1e6 / tick_hz,
+            "pid": 1,
+            "tid": 1,
+        }
+        kind = REC_NAMES.get(rtype, "unknown")
+        if kind in ("dispatch", "idle"):
+            ev["ph"] = "B"
+            if kind == "idle":
+                ev["cat"] = "idle"
+            elif queued is None:
+                # Version 1 dumps stored the queue level in size, saturated at 255
+                ev["args"] = {"queue_bytes_left": size}
+            else:
+                ev["args"] = {"size": size, "queue_bytes_left": queued}
+        elif kind == "end":
+            ev["ph"] = "E"
+        else:
+            # push, drop and yield are instants. Pushes may come from ISRs, so they get their own row.
+            ev["ph"] = "i"
+            ev["s"] = "t"
+            ev["name"] = "%s %s" % (kind, ev["name"])
+            if kind in ("push", "drop"):
+                ev["tid"] = 2
+                ev["args"] = {"size": size}
+        events.append(ev)
+    
+    meta = [
+        {"name": "thread_name", "ph": "M", "pid": 1, "tid": 1, "args": {"name": "event handler"}},
+        {"name": "thread_name", "ph": "M", "pid": 1, "tid": 2, "args": {"name": "pushes"}},
+    ]
+    return {"traceEvents": meta + events, "displayTimeUnit": "ms"}
+
+#---------------------------------------------------------------------------------------------------
+def to_text(records, symbolize, tick_hz, out):
+    depth = 0
+    for ticks, rtype, size, queued, addr in records:
+        kind = REC_NAMES.get(rtype, "unknown")
+        if kind == "end":
+            depth = max(depth - 1, 0)
+        out.write("%12.1f us  %s%-8s %s" % (ticks * 1e6 / tick_hz, "  " * depth, kind, symbolize(addr)))
+        if kind in ("push", "drop"):
+            out.write(" (%d bytes)" % size)
+        elif (kind == "dispatch") and (queued is not None):
+            out.write(" (%d bytes, %d bytes left in queue)" % (size, queued))
+        out.write("\n")
+        if kind in ("dispatch", "idle"):
+            depth += 1
+
+#---------------------------------------------------------------------------------------------------
+def main():
+    parser = argparse.ArgumentParser(description="Decode an event queue trace dump")
+    parser.add_argument("dump", help="Binary dump written by event_TraceDump()")
+    parser.add_argument("elf", nargs="?", help="Firmware ELF file used to name the handlers")
+    parser.add_argument("--tick-hz", type=float, required=True,
+                        help="Frequency of the timer read by event_stats_time()")
+    parser.add_argument("--nm", default="msp430-elf-nm", help="nm executable (default: %(default)s)")
+    parser.add_argument("--text", action="store_true", help="Print a text timeline instead")
+    parser.add_argument("-o", "--output", help="Output file (default: stdout)")
+    args = parser.parse_args()
+    
+    with open(args.dump, "rb") as f:
+        records = read_dump(f.read())
+    
+    if args.elf:
+        symbolize = Symbolizer(load_symbols(args.elf, args.nm))
+    else:
+        symbolize = lambda addr: "0x%x" % addr
+    
+    out = open(args.output, "w") if args.output else sys.stdout
+    if args.text:
+        to_text(records, symbolize, args.tick_hz, out)
+    else:
+        json.dump(to_chrome(records, symbolize, args.tick_hz), out, indent=1)
+        out.write("\n")
+
+if __name__ == "__main__":
+    main()